@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cinttypes>
+#include <algorithm>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cista/hash.h"
+
+namespace cista {
+
+// Checksums of consecutive fixed size blocks (mode::BLOCK_CHECKSUMS).
+// Each block can be verified on its own, e.g. on first access of a
+// memory mapped file instead of hashing the whole file up front.
+constexpr auto const BLOCK_CHECKSUM_SIZE = std::size_t{4096U};
+
+template <typename Hasher>
+hash_t block_checksum(std::string_view const block) {
+  auto h = Hasher{};
+  h.update(block);
+  return h.finish();
+}
+
+// Streaming interface: hashes of the blocks of the first `size` bytes.
+// Input beyond `size` is ignored. finish() always returns one hash per
+// block (ceil(size / block_size)), also if less input has been provided.
+template <typename Hasher>
+struct block_hasher {
+  explicit block_hasher(std::size_t const size,
+                        std::size_t const block_size = BLOCK_CHECKSUM_SIZE)
+      : size_{size}, block_size_{block_size} {}
+
+  void update(void const* data, std::size_t size) {
+    auto p = static_cast<uint8_t const*>(data);
+    size = std::min(size, size_ - consumed_);
+    while (size != 0U) {
+      auto const n = std::min(size, block_size_ - block_fill_);
+      block_.update(p, n);
+      block_fill_ += n;
+      consumed_ += n;
+      p += n;
+      size -= n;
+      if (block_fill_ == block_size_) {
+        finish_block();
+      }
+    }
+  }
+
+  void update(std::string_view const s) { update(s.data(), s.size()); }
+
+  std::vector<hash_t> finish() {
+    if (block_fill_ != 0U) {
+      finish_block();
+    }
+    hashes_.resize((size_ + block_size_ - 1U) / block_size_);
+    return std::move(hashes_);
+  }
+
+private:
+  void finish_block() {
+    hashes_.emplace_back(block_.finish());
+    block_ = Hasher{};
+    block_fill_ = 0U;
+  }
+
+  std::size_t size_, block_size_;
+  std::size_t consumed_{0U}, block_fill_{0U};
+  Hasher block_;
+  std::vector<hash_t> hashes_;
+};
+
+}  // namespace cista
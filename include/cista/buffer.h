@@ -1,16 +1,22 @@
 #pragma once
 
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 
 #include "cista/verify.h"
 
 namespace cista {
 
+// Byte buffer with geometric growth. In contrast to std::vector<uint8_t>,
+// new memory is not initialized (resize() followed by memcpy() touches
+// every byte only once).
 struct buffer final {
-  buffer() : buf_(nullptr), size_(0) {}
+  buffer() : buf_(nullptr), size_(0), capacity_(0) {}
 
-  explicit buffer(std::size_t size) : buf_(malloc(size)), size_(size) {
+  explicit buffer(std::size_t size)
+      : buf_(malloc(size)), size_(size), capacity_(size) {
     verify(buf_ != nullptr, "buffer initialization failed");
   }
 
@@ -30,20 +36,46 @@ struct buffer final {
   buffer(buffer const&) = delete;
   buffer& operator=(buffer const&) = delete;
 
-  buffer(buffer&& o) noexcept : buf_(o.buf_), size_(o.size_) {
+  buffer(buffer&& o) noexcept
+      : buf_(o.buf_), size_(o.size_), capacity_(o.capacity_) {
     o.buf_ = nullptr;
     o.size_ = 0;
+    o.capacity_ = 0;
   }
 
   buffer& operator=(buffer&& o) noexcept {
-    buf_ = o.buf_;
-    size_ = o.size_;
-    o.buf_ = nullptr;
-    o.size_ = 0;
+    if (this != &o) {
+      std::free(buf_);
+      buf_ = o.buf_;
+      size_ = o.size_;
+      capacity_ = o.capacity_;
+      o.buf_ = nullptr;
+      o.size_ = 0;
+      o.capacity_ = 0;
+    }
     return *this;
   }
 
+  // Grows the allocation to at least new_capacity bytes.
+  void reserve(std::size_t const new_capacity) {
+    if (new_capacity > capacity_) {
+      auto const new_buf = std::realloc(buf_, new_capacity);
+      verify(new_buf != nullptr, "buffer reallocation failed");
+      buf_ = new_buf;
+      capacity_ = new_capacity;
+    }
+  }
+
+  // Sets the size. Bytes added at the end are NOT initialized.
+  void resize(std::size_t const new_size) {
+    if (new_size > capacity_) {
+      reserve(std::max(new_size, 2U * capacity_));
+    }
+    size_ = new_size;
+  }
+
   inline std::size_t size() const { return size_; }
+  inline std::size_t capacity() const { return capacity_; }
 
   inline unsigned char* data() { return static_cast<unsigned char*>(buf_); }
   inline unsigned char const* data() const {
@@ -52,12 +84,22 @@ struct buffer final {
 
   inline unsigned char* begin() { return data(); }
   inline unsigned char* end() { return data() + size_; }
+  inline unsigned char const* begin() const { return data(); }
+  inline unsigned char const* end() const { return data() + size_; }
 
-  unsigned char& operator[](size_t i) { return *(data() + i); }
-  unsigned char const& operator[](size_t i) const { return *(data() + i); }
+  // Element access, i < size() (use data() for pointers to the storage).
+  unsigned char& operator[](size_t i) {
+    assert(i < size_);
+    return *(data() + i);
+  }
+  unsigned char const& operator[](size_t i) const {
+    assert(i < size_);
+    return *(data() + i);
+  }
 
   void* buf_;
   std::size_t size_;
+  std::size_t capacity_;
 };
 
 }  // namespace cista
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cinttypes>
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+#include "cista/hash.h"
+#include "cista/parallel_for.h"
+
+namespace cista {
+
+// Checksum over fixed size chunks: Hasher(little endian chunk hashes) with
+// chunk hash = Hasher(chunk). The chunks are independent, so the checksum
+// can be computed in parallel (chunked_checksum) or as a stream
+// (chunked_hasher) with identical results.
+constexpr auto const CHECKSUM_CHUNK_SIZE = std::size_t{1U} << 20U;  // 1 MB
+
+template <typename Hasher>
+struct chunked_hasher {
+  void update(void const* data, std::size_t size) {
+    auto p = static_cast<uint8_t const*>(data);
+    while (size != 0U) {
+      auto const n = std::min(size, CHECKSUM_CHUNK_SIZE - chunk_fill_);
+      chunk_.update(p, n);
+      chunk_fill_ += n;
+      p += n;
+      size -= n;
+      if (chunk_fill_ == CHECKSUM_CHUNK_SIZE) {
+        add_chunk(outer_, chunk_.finish());
+        chunk_ = Hasher{};
+        chunk_fill_ = 0U;
+        ++n_chunks_;
+      }
+    }
+  }
+
+  void update(std::string_view const s) { update(s.data(), s.size()); }
+
+  hash_t finish() const {
+    auto outer = outer_;
+    if (chunk_fill_ != 0U || n_chunks_ == 0U) {
+      add_chunk(outer, chunk_.finish());
+    }
+    return outer.finish();
+  }
+
+  static void add_chunk(Hasher& outer, hash_t const chunk_hash) {
+    uint8_t bytes[sizeof(hash_t)];
+    for (auto i = 0U; i != sizeof(hash_t); ++i) {
+      bytes[i] = static_cast<uint8_t>(chunk_hash >> (8U * i));
+    }
+    outer.update(bytes, sizeof(bytes));
+  }
+
+private:
+  Hasher outer_;
+  Hasher chunk_;
+  std::size_t chunk_fill_{0U};
+  std::size_t n_chunks_{0U};
+};
+
+template <typename Hasher>
+hash_t chunked_checksum(std::string_view const s,
+                        unsigned const parallelism = 1U) {
+  auto const n_chunks = std::max(
+      std::size_t{1U},
+      (s.size() + CHECKSUM_CHUNK_SIZE - 1U) / CHECKSUM_CHUNK_SIZE);
+
+  auto chunk_hashes = std::vector<hash_t>(n_chunks);
+  parallel_for(parallelism, n_chunks,
+               [&](std::size_t const from, std::size_t const to) {
+                 for (auto i = from; i != to; ++i) {
+                   auto h = Hasher{};
+                   h.update(s.substr(i * CHECKSUM_CHUNK_SIZE,
+                                     CHECKSUM_CHUNK_SIZE));
+                   chunk_hashes[i] = h.finish();
+                 }
+               });
+
+  auto outer = Hasher{};
+  for (auto const h : chunk_hashes) {
+    chunked_hasher<Hasher>::add_chunk(outer, h);
+  }
+  return outer.finish();
+}
+
+}  // namespace cista
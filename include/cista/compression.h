@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "cista/endian/conversion.h"
+#include "cista/lz.h"
+#include "cista/parallel_for.h"
+#include "cista/targets/buf.h"
+#include "cista/verify.h"
+
+namespace cista {
+
+// Block compressed container, e.g. for the output of serialize():
+//
+//   [magic][block size][size][block count][block end offsets][blocks]
+//
+// Header fields are uint64_t little endian. Block i holds the bytes
+// [i * block size, min(size, (i + 1) * block size)[ of the uncompressed
+// data, stored (lz.h) at [end[i - 1], end[i][ relative to the first block
+// with end[-1] = 0. Blocks that do not get smaller are stored as is.
+// Blocks are independent: compressed_view::decompress() restores all of
+// them in parallel, block_cache decompresses single blocks on demand.
+constexpr auto const COMPRESSION_MAGIC = uint64_t{0x315A4C4154534943ULL};
+constexpr auto const COMPRESSION_BLOCK_SIZE = std::size_t{64U * 1024U};
+constexpr auto const MAX_COMPRESSION_BLOCK_SIZE = uint64_t{1U} << 32U;
+
+namespace compression_detail {
+
+constexpr auto const HEADER_SIZE = 4U * sizeof(uint64_t);
+
+// An lz sequence of c bytes restores at most 255 * c bytes.
+constexpr auto const MAX_EXPANSION = uint64_t{255U};
+
+inline uint64_t read_u64(uint8_t const* p) {
+  auto v = uint64_t{};
+  std::memcpy(&v, p, sizeof(v));
+  return convert_endian<mode::NONE>(v);
+}
+
+inline uint8_t* write_u64(uint8_t* p, uint64_t const v) {
+  auto const le = convert_endian<mode::NONE>(v);
+  std::memcpy(p, &le, sizeof(le));
+  return p + sizeof(le);
+}
+
+}  // namespace compression_detail
+
+inline byte_buf compress(void const* data, std::size_t const size,
+                         std::size_t const block_size = COMPRESSION_BLOCK_SIZE,
+                         unsigned const parallelism = hardware_parallelism()) {
+  using namespace compression_detail;
+  verify(block_size != 0U && block_size <= MAX_COMPRESSION_BLOCK_SIZE,
+         "compress: bad block size");
+
+  auto const in = static_cast<uint8_t const*>(data);
+  auto const count = (size + block_size - 1U) / block_size;
+
+  // Empty buffer: the block is stored as is.
+  std::vector<byte_buf> compressed(count);
+  parallel_for(parallelism, count, [&](std::size_t from, std::size_t to) {
+    auto tmp = std::vector<uint8_t>(lz_compress_bound(block_size));
+    for (auto i = from; i != to; ++i) {
+      auto const first = i * block_size;
+      auto const n = std::min(block_size, size - first);
+      auto const compressed_size = lz_compress(in + first, n, tmp.data());
+      if (compressed_size < n) {
+        compressed[i] = byte_buf{reinterpret_cast<char const*>(tmp.data()),
+                                 compressed_size};
+      }
+    }
+  });
+
+  auto blocks_size = std::size_t{0U};
+  for (auto i = std::size_t{0U}; i != count; ++i) {
+    blocks_size += compressed[i].size() != 0U
+                       ? compressed[i].size()
+                       : std::min(block_size, size - i * block_size);
+  }
+
+  auto out = byte_buf{HEADER_SIZE + count * sizeof(uint64_t) + blocks_size};
+  auto p = out.data();
+  p = write_u64(p, COMPRESSION_MAGIC);
+  p = write_u64(p, block_size);
+  p = write_u64(p, size);
+  p = write_u64(p, count);
+
+  auto const index = p;
+  auto blocks = p + count * sizeof(uint64_t);
+  auto end = std::size_t{0U};
+  for (auto i = std::size_t{0U}; i != count; ++i) {
+    if (compressed[i].size() != 0U) {
+      std::memcpy(blocks + end, compressed[i].data(), compressed[i].size());
+      end += compressed[i].size();
+    } else {
+      auto const n = std::min(block_size, size - i * block_size);
+      std::memcpy(blocks + end, in + i * block_size, n);
+      end += n;
+    }
+    write_u64(index + i * sizeof(uint64_t), end);
+  }
+  return out;
+}
+
+template <typename Container,
+          typename = std::enable_if_t<!std::is_pointer_v<Container>>>
+byte_buf compress(Container const& c,
+                  std::size_t const block_size = COMPRESSION_BLOCK_SIZE,
+                  unsigned const parallelism = hardware_parallelism()) {
+  return compress(c.data(), c.size(), block_size, parallelism);
+}
+
+// Read access to the output of compress() (e.g. memory mapped). The header
+// and block index are validated on construction, block contents on
+// decompression. Does not own the data.
+struct compressed_view {
+  compressed_view(void const* data, std::size_t const size) {
+    using namespace compression_detail;
+    auto const p = static_cast<uint8_t const*>(data);
+    verify(size >= HEADER_SIZE, "compressed_view: header truncated");
+    verify(read_u64(p) == COMPRESSION_MAGIC, "compressed_view: bad magic");
+
+    auto const block_size = read_u64(p + 8U);
+    auto const uncompressed_size = read_u64(p + 16U);
+    auto const count = read_u64(p + 24U);
+    verify(block_size != 0U && block_size <= MAX_COMPRESSION_BLOCK_SIZE &&
+               block_size == static_cast<std::size_t>(block_size) &&
+               uncompressed_size == static_cast<std::size_t>(uncompressed_size),
+           "compressed_view: bad header");
+    verify(count == uncompressed_size / block_size +
+                        (uncompressed_size % block_size != 0U ? 1U : 0U),
+           "compressed_view: bad block count");
+    verify(count <= (size - HEADER_SIZE) / sizeof(uint64_t),
+           "compressed_view: index truncated");
+
+    block_size_ = static_cast<std::size_t>(block_size);
+    size_ = static_cast<std::size_t>(uncompressed_size);
+    count_ = static_cast<std::size_t>(count);
+    index_ = p + HEADER_SIZE;
+    blocks_ = index_ + count_ * sizeof(uint64_t);
+
+    auto const blocks_size = static_cast<std::size_t>(size - HEADER_SIZE) -
+                             count_ * sizeof(uint64_t);
+    // Bounds the uncompressed size by the available compressed bytes, so
+    // a forged header cannot request arbitrarily large allocations.
+    auto prev = uint64_t{0U};
+    for (auto i = std::size_t{0U}; i != count_; ++i) {
+      auto const end = read_u64(index_ + i * sizeof(uint64_t));
+      verify(end >= prev && end <= blocks_size, "compressed_view: bad index");
+      auto const n = uncompressed_block_size(i);
+      verify(end - prev <= n && n <= MAX_EXPANSION * (end - prev),
+             "compressed_view: bad block size");
+      prev = end;
+    }
+  }
+
+  std::size_t size() const { return size_; }
+  std::size_t block_size() const { return block_size_; }
+  std::size_t block_count() const { return count_; }
+
+  std::size_t uncompressed_block_size(std::size_t const i) const {
+    return std::min(block_size_, size_ - i * block_size_);
+  }
+
+  // Writes the uncompressed_block_size(i) bytes of block i to out.
+  void decompress_block(std::size_t const i, uint8_t* out) const {
+    auto const begin = i == 0U ? std::size_t{0U} : block_end(i - 1U);
+    auto const end = block_end(i);
+    auto const n = uncompressed_block_size(i);
+    if (end - begin == n) {
+      std::memcpy(out, blocks_ + begin, n);
+    } else {
+      lz_decompress(blocks_ + begin, end - begin, out, n);
+    }
+  }
+
+  // Decompresses all blocks (in parallel), e.g. to deserialize() them.
+  byte_buf decompress(
+      unsigned const parallelism = hardware_parallelism()) const {
+    if (size_ == 0U) {
+      return byte_buf{};
+    }
+    auto out = byte_buf{size_};
+    parallel_for(parallelism, count_, [&](std::size_t from, std::size_t to) {
+      for (auto i = from; i != to; ++i) {
+        decompress_block(i, out.data() + i * block_size_);
+      }
+    });
+    return out;
+  }
+
+private:
+  std::size_t block_end(std::size_t const i) const {
+    return static_cast<std::size_t>(
+        compression_detail::read_u64(index_ + i * sizeof(uint64_t)));
+  }
+
+  std::size_t block_size_{0U}, size_{0U}, count_{0U};
+  uint8_t const* index_{nullptr};
+  uint8_t const* blocks_{nullptr};
+};
+
+// User space page cache: decompresses blocks on first access and keeps
+// the `frames` most recently used ones. Not thread-safe (one cache per
+// thread, sharing the same compressed_view).
+struct block_cache {
+  static constexpr auto const NO_FRAME =
+      std::numeric_limits<std::size_t>::max();
+
+  block_cache(compressed_view const& view, std::size_t const frames)
+      : view_{view},
+        frame_size_{std::min(view.block_size(), view.size())},
+        frame_block_(std::max(std::size_t{1U}, frames), NO_FRAME),
+        frame_last_use_(frame_block_.size(), 0U),
+        block_frame_(view.block_count(), NO_FRAME) {
+    verify(frame_size_ == 0U ||
+               frame_block_.size() <=
+                   std::numeric_limits<std::size_t>::max() / frame_size_,
+           "block_cache: too many frames");
+    frames_.resize(frame_block_.size() * frame_size_);
+  }
+
+  // Uncompressed content of block i. Valid until the next call.
+  std::string_view block(std::size_t const i) {
+    verify(i < view_.block_count(), "block_cache: block out of range");
+    auto frame = block_frame_[i];
+    if (frame != NO_FRAME) {
+      ++hits_;
+    } else {
+      ++misses_;
+      frame = static_cast<std::size_t>(
+          std::min_element(begin(frame_last_use_), end(frame_last_use_)) -
+          begin(frame_last_use_));
+      if (frame_block_[frame] != NO_FRAME) {
+        block_frame_[frame_block_[frame]] = NO_FRAME;
+      }
+      frame_block_[frame] = NO_FRAME;
+      view_.decompress_block(i, frame_data(frame));
+      frame_block_[frame] = i;
+      block_frame_[i] = frame;
+    }
+    frame_last_use_[frame] = ++clock_;
+    return {reinterpret_cast<char const*>(frame_data(frame)),
+            view_.uncompressed_block_size(i)};
+  }
+
+  // Copies the uncompressed bytes [offset, offset + n[ to out.
+  void read(std::size_t offset, void* out, std::size_t n) {
+    verify(offset <= view_.size() && n <= view_.size() - offset,
+           "block_cache: read out of range");
+    auto dest = static_cast<uint8_t*>(out);
+    while (n != 0U) {
+      auto const b = block(offset / view_.block_size());
+      auto const in_block = offset % view_.block_size();
+      auto const k = std::min(n, b.size() - in_block);
+      std::memcpy(dest, b.data() + in_block, k);
+      dest += k;
+      offset += k;
+      n -= k;
+    }
+  }
+
+  std::size_t hits_{0U}, misses_{0U};
+
+private:
+  uint8_t* frame_data(std::size_t const frame) {
+    return frames_.data() + frame * frame_size_;
+  }
+
+  compressed_view view_;
+  std::size_t frame_size_;
+  std::vector<uint8_t> frames_;
+  std::vector<std::size_t> frame_block_;
+  std::vector<uint64_t> frame_last_use_;
+  std::vector<std::size_t> block_frame_;
+  uint64_t clock_{0U};
+};
+
+}  // namespace cista
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "cista/containers/array.h"
+#include "cista/containers/hash_map.h"
+#include "cista/containers/hash_set.h"
 #include "cista/containers/string.h"
 #include "cista/containers/unique_ptr.h"
 #include "cista/containers/vector.h"
@@ -16,8 +18,22 @@
   template <typename T>                                             \
   using vector = cista::basic_vector<T, ptr<T>>;                    \
                                                                     \
+  template <typename T>                                             \
+  using vector64 = cista::basic_vector<T, ptr<T>, uint64_t>;        \
+                                                                    \
   using string = cista::basic_string<ptr<char const>>;              \
                                                                     \
+  using string64 = cista::basic_string<ptr<char const>, uint64_t>;  \
+                                                                    \
+  template <typename K, typename V,                                 \
+            typename Hash = cista::hashing<K>,                      \
+            typename Eq = cista::equal_to<K>>                       \
+  using hash_map = cista::hash_map<K, V, ptr, Hash, Eq>;            \
+                                                                    \
+  template <typename T, typename Hash = cista::hashing<T>,          \
+            typename Eq = cista::equal_to<T>>                       \
+  using hash_set = cista::hash_set<T, ptr, Hash, Eq>;               \
+                                                                    \
   template <typename T, typename... Args>                           \
   unique_ptr<T> make_unique(Args&&... args) {                       \
     return unique_ptr<T>{new T{std::forward<Args>(args)...}, true}; \
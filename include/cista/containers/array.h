@@ -3,11 +3,14 @@
 #include <cinttypes>
 #include <iterator>
 #include <stdexcept>
+#include <type_traits>
 
 namespace cista {
 
 template <typename T, std::size_t Size>
 struct array {
+  using value_type = T;
+
   array() = default;
 
   constexpr size_t size() const { return Size; }
@@ -57,4 +60,13 @@ struct array {
   T el_[Size];
 };
 
+template <typename T>
+struct is_array_helper : std::false_type {};
+
+template <typename T, std::size_t Size>
+struct is_array_helper<array<T, Size>> : std::true_type {};
+
+template <typename T>
+constexpr bool is_array_v = is_array_helper<std::remove_cv_t<T>>::value;
+
 }  // namespace cista
\ No newline at end of file
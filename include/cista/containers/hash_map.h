@@ -0,0 +1,28 @@
+#pragma once
+
+#include "cista/containers/hash_storage.h"
+#include "cista/containers/pair.h"
+#include "cista/hashing.h"
+
+namespace cista {
+
+struct get_first {
+  template <typename T>
+  auto& operator()(T&& t) const {
+    return t.first;
+  }
+};
+
+struct get_second {
+  template <typename T>
+  auto& operator()(T&& t) const {
+    return t.second;
+  }
+};
+
+template <typename Key, typename Value, template <typename> typename Ptr,
+          typename Hash = hashing<Key>, typename Eq = equal_to<Key>>
+using hash_map =
+    hash_storage<pair<Key, Value>, Ptr, get_first, get_second, Hash, Eq>;
+
+}  // namespace cista
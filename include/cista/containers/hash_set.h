@@ -0,0 +1,21 @@
+#pragma once
+
+#include <utility>
+
+#include "cista/containers/hash_storage.h"
+#include "cista/hashing.h"
+
+namespace cista {
+
+struct identity {
+  template <typename T>
+  T&& operator()(T&& t) const {
+    return std::forward<T>(t);
+  }
+};
+
+template <typename T, template <typename> typename Ptr,
+          typename Hash = hashing<T>, typename Eq = equal_to<T>>
+using hash_set = hash_storage<T, Ptr, identity, identity, Hash, Eq>;
+
+}  // namespace cista
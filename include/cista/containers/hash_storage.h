@@ -0,0 +1,583 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CISTA_HASH_STORAGE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "cista/decay.h"
+#include "cista/hash.h"
+
+namespace cista {
+
+// Open addressing hash table (SwissTable layout):
+// - entries_: capacity_ slots, capacity_ = 2^n - 1 (>= 15)
+// - ctrl_: one control byte per slot (EMPTY, DELETED, or the lower 7 bits
+//   of the hash of the entry = H2), followed by END and a copy of the
+//   first GROUP_WIDTH - 1 control bytes (probing never wraps inside a
+//   group).
+// Lookups compare the H2 of 16 slots at once (SSE2 or portable bit
+// operations) and only compare keys of matching slots. The group width
+// and the hash function are part of the serialized format and therefore
+// identical on all platforms.
+namespace hash_storage_detail {
+
+using ctrl_t = int8_t;
+
+constexpr auto const EMPTY = ctrl_t{-128};
+constexpr auto const DELETED = ctrl_t{-2};
+constexpr auto const END = ctrl_t{-1};
+
+constexpr auto const GROUP_WIDTH = std::size_t{16U};
+constexpr auto const CLONED_BYTES = GROUP_WIDTH - 1U;
+constexpr auto const MIN_CAPACITY = std::size_t{15U};
+
+constexpr bool is_full(ctrl_t const c) { return c >= 0; }
+
+constexpr std::size_t h1(hash_t const h) {
+  return static_cast<std::size_t>(h >> 7U);
+}
+
+constexpr ctrl_t h2(hash_t const h) { return static_cast<ctrl_t>(h & 0x7FU); }
+
+inline unsigned trailing_zeros(uint32_t const x) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, x);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(x));
+#endif
+}
+
+// Leading zeros of a 16 bit group mask.
+inline unsigned leading_zeros16(uint32_t const x) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanReverse(&index, x);
+  return 15U - static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_clz(x)) - 16U;
+#endif
+}
+
+// Bit i set <=> control byte i of the group matches.
+struct group {
+  explicit group(ctrl_t const* pos) {
+#ifdef CISTA_HASH_STORAGE_SSE2
+    ctrl_ = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pos));
+#else
+    std::memcpy(ctrl_, pos, GROUP_WIDTH);
+#endif
+  }
+
+#ifdef CISTA_HASH_STORAGE_SSE2
+  uint32_t match(ctrl_t const h) const {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), ctrl_)));
+  }
+
+  uint32_t match_empty() const { return match(EMPTY); }
+
+  uint32_t match_empty_or_deleted() const {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(END), ctrl_)));
+  }
+
+  __m128i ctrl_;
+#else
+  uint32_t match(ctrl_t const h) const {
+    auto mask = uint32_t{0U};
+    for (auto i = 0U; i != GROUP_WIDTH; ++i) {
+      mask |= static_cast<uint32_t>(ctrl_[i] == h) << i;
+    }
+    return mask;
+  }
+
+  uint32_t match_empty() const { return match(EMPTY); }
+
+  uint32_t match_empty_or_deleted() const {
+    auto mask = uint32_t{0U};
+    for (auto i = 0U; i != GROUP_WIDTH; ++i) {
+      mask |= static_cast<uint32_t>(ctrl_[i] < END) << i;
+    }
+    return mask;
+  }
+
+  ctrl_t ctrl_[GROUP_WIDTH];
+#endif
+};
+
+// Triangular probing over groups: visits every group once.
+struct probe_seq {
+  probe_seq(std::size_t const hash, std::size_t const mask)
+      : mask_{mask}, offset_{hash & mask} {}
+
+  std::size_t offset(unsigned const i) const { return (offset_ + i) & mask_; }
+
+  void next() {
+    index_ += GROUP_WIDTH;
+    offset_ = (offset_ + index_) & mask_;
+  }
+
+  std::size_t mask_, offset_, index_{0U};
+};
+
+}  // namespace hash_storage_detail
+
+template <typename T, template <typename> typename Ptr, typename GetKey,
+          typename GetValue, typename Hash, typename Eq>
+struct hash_storage {
+  using ctrl_t = hash_storage_detail::ctrl_t;
+  using size_type = uint32_t;
+  using value_type = T;
+  using key_type = decay_t<decltype(GetKey{}(std::declval<T&>()))>;
+  using mapped_type = decay_t<decltype(GetValue{}(std::declval<T&>()))>;
+  using hasher = Hash;
+  using key_equal = Eq;
+
+  template <bool Const>
+  struct iterator_base {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, T const*, T*>;
+    using reference = std::conditional_t<Const, T const&, T&>;
+
+    iterator_base() = default;
+    iterator_base(pointer entry, ctrl_t const* ctrl)
+        : entry_{entry}, ctrl_{ctrl} {}
+
+    operator iterator_base<true>() const { return {entry_, ctrl_}; }
+
+    reference operator*() const { return *entry_; }
+    pointer operator->() const { return entry_; }
+
+    iterator_base& operator++() {
+      ++entry_;
+      ++ctrl_;
+      skip_empty();
+      return *this;
+    }
+
+    iterator_base operator++(int) {
+      auto const prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    friend bool operator==(iterator_base const& a, iterator_base const& b) {
+      return a.entry_ == b.entry_;
+    }
+
+    friend bool operator!=(iterator_base const& a, iterator_base const& b) {
+      return !(a == b);
+    }
+
+    void skip_empty() {
+      while (ctrl_ != nullptr && !hash_storage_detail::is_full(*ctrl_) &&
+             *ctrl_ != hash_storage_detail::END) {
+        ++entry_;
+        ++ctrl_;
+      }
+    }
+
+    pointer entry_{nullptr};
+    ctrl_t const* ctrl_{nullptr};
+  };
+
+  using iterator = iterator_base<false>;
+  using const_iterator = iterator_base<true>;
+
+  hash_storage() = default;
+
+  hash_storage(std::initializer_list<T> init) {
+    reserve(init.size());
+    for (auto const& el : init) {
+      insert(el);
+    }
+  }
+
+  hash_storage(hash_storage const& o) { copy_from(o); }
+
+  hash_storage(hash_storage&& o) noexcept { move_from(std::move(o)); }
+
+  hash_storage& operator=(hash_storage const& o) {
+    if (this != &o) {
+      clear();
+      copy_from(o);
+    }
+    return *this;
+  }
+
+  hash_storage& operator=(hash_storage&& o) noexcept {
+    if (this != &o) {
+      deallocate();
+      move_from(std::move(o));
+    }
+    return *this;
+  }
+
+  ~hash_storage() { deallocate(); }
+
+  iterator begin() { return make_iterator<false>(0U); }
+  iterator end() { return iterator{entries() + capacity_, nullptr}; }
+  const_iterator begin() const { return make_iterator<true>(0U); }
+  const_iterator end() const {
+    return const_iterator{entries() + capacity_, nullptr};
+  }
+
+  friend iterator begin(hash_storage& h) { return h.begin(); }
+  friend iterator end(hash_storage& h) { return h.end(); }
+  friend const_iterator begin(hash_storage const& h) { return h.begin(); }
+  friend const_iterator end(hash_storage const& h) { return h.end(); }
+
+  size_type size() const { return size_; }
+  bool empty() const { return size_ == 0U; }
+  size_type capacity() const { return capacity_; }
+
+  template <typename Key>
+  iterator find(Key const& key) {
+    auto const entry = find_entry(key);
+    return entry == nullptr ? end() : iterator{entry, ctrl_at(entry)};
+  }
+
+  template <typename Key>
+  const_iterator find(Key const& key) const {
+    auto const entry = find_entry(key);
+    return entry == nullptr ? end() : const_iterator{entry, ctrl_at(entry)};
+  }
+
+  template <typename Key>
+  bool contains(Key const& key) const {
+    return find_entry(key) != nullptr;
+  }
+
+  template <typename Key>
+  size_type count(Key const& key) const {
+    return contains(key) ? 1U : 0U;
+  }
+
+  template <typename Key>
+  auto& at(Key const& key) {
+    auto const entry = find_entry(key);
+    if (entry == nullptr) {
+      throw std::out_of_range{"hash_storage::at() key not found"};
+    }
+    return GetValue{}(*entry);
+  }
+
+  template <typename Key>
+  auto const& at(Key const& key) const {
+    auto const entry = find_entry(key);
+    if (entry == nullptr) {
+      throw std::out_of_range{"hash_storage::at() key not found"};
+    }
+    return GetValue{}(*entry);
+  }
+
+  // hash_map only: inserts a default constructed value if key is missing.
+  template <typename Key>
+  auto& operator[](Key&& key) {
+    auto const [i, inserted] = find_or_prepare_insert(key);
+    if (inserted) {
+      new (entries() + i)
+          T{static_cast<key_type>(std::forward<Key>(key)), mapped_type{}};
+    }
+    return GetValue{}(entries()[i]);
+  }
+
+  std::pair<iterator, bool> insert(T const& el) { return emplace(el); }
+  std::pair<iterator, bool> insert(T&& el) { return emplace(std::move(el)); }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    auto el = T{std::forward<Args>(args)...};
+    auto const [i, inserted] = find_or_prepare_insert(GetKey{}(el));
+    if (inserted) {
+      new (entries() + i) T{std::move(el)};
+    }
+    return {iterator{entries() + i, ctrl_ + i}, inserted};
+  }
+
+  template <typename Key>
+  size_type erase(Key const& key) {
+    auto const entry = find_entry(key);
+    if (entry == nullptr) {
+      return 0U;
+    }
+    erase_index(static_cast<std::size_t>(entry - entries()));
+    return 1U;
+  }
+
+  iterator erase(iterator const it) { return erase(const_iterator{it}); }
+
+  iterator erase(const_iterator const it) {
+    auto const i = static_cast<std::size_t>(it.entry_ - entries());
+    erase_index(i);
+    return make_iterator<false>(i + 1U);
+  }
+
+  void clear() {
+    if (capacity_ == 0U) {
+      return;
+    }
+    destroy_entries();
+    std::memset(static_cast<void*>(entries()), 0, capacity_ * sizeof(T));
+    reset_ctrl();
+    size_ = 0U;
+    growth_left_ = static_cast<size_type>(capacity_to_growth(capacity_));
+  }
+
+  // Allocates space for at least n entries without further rehashing.
+  void reserve(std::size_t const n) {
+    if (n > size_ + growth_left_) {
+      resize(growth_to_capacity(n));
+    }
+  }
+
+  static constexpr std::size_t capacity_to_growth(std::size_t const c) {
+    return c - c / 8U;  // max. load factor 7/8
+  }
+
+  static constexpr std::size_t growth_to_capacity(std::size_t const n) {
+    auto c = hash_storage_detail::MIN_CAPACITY;
+    while (capacity_to_growth(c) < n) {
+      c = c * 2U + 1U;
+    }
+    return c;
+  }
+
+  // Size of the allocation holding entries and control bytes.
+  static constexpr std::size_t memory_size(std::size_t const capacity) {
+    return capacity == 0U ? 0U
+                          : capacity * sizeof(T) + capacity + 1U +
+                                hash_storage_detail::CLONED_BYTES;
+  }
+
+  T* entries() { return static_cast<T*>(entries_); }
+  T const* entries() const { return static_cast<T const*>(entries_); }
+
+  Ptr<T> entries_{nullptr};
+  Ptr<ctrl_t> ctrl_{nullptr};
+  size_type size_{0U};
+  size_type capacity_{0U};
+  size_type growth_left_{0U};
+  bool self_allocated_{false};
+  uint8_t __fill_0__{0};
+  uint16_t __fill_1__{0};
+
+private:
+  template <bool Const>
+  iterator_base<Const> make_iterator(std::size_t const i) const {
+    if (capacity_ == 0U) {
+      return {nullptr, nullptr};
+    }
+    auto it = iterator_base<Const>{
+        const_cast<T*>(entries()) + i,  // NOLINT
+        static_cast<ctrl_t const*>(ctrl_) + i};
+    it.skip_empty();
+    if (*it.ctrl_ == hash_storage_detail::END) {
+      it.ctrl_ = nullptr;
+    }
+    return it;
+  }
+
+  ctrl_t const* ctrl_at(T const* entry) const {
+    return static_cast<ctrl_t const*>(ctrl_) + (entry - entries());
+  }
+
+  template <typename Key>
+  T* find_entry(Key const& key) const {
+    using namespace hash_storage_detail;
+    if (size_ == 0U) {
+      return nullptr;
+    }
+    auto const h = Hash{}(key);
+    auto const ctrl = static_cast<ctrl_t const*>(ctrl_);
+    auto const entries = const_cast<T*>(this->entries());  // NOLINT
+    for (auto seq = probe_seq{h1(h), capacity_};; seq.next()) {
+      auto const g = group{ctrl + seq.offset_};
+      for (auto m = g.match(h2(h)); m != 0U; m &= m - 1U) {
+        auto const i = seq.offset(trailing_zeros(m));
+        if (Eq{}(GetKey{}(entries[i]), key)) {
+          return entries + i;
+        }
+      }
+      if (g.match_empty() != 0U) {
+        return nullptr;
+      }
+    }
+  }
+
+  // Returns the slot index of key and whether it has to be constructed.
+  template <typename Key>
+  std::pair<std::size_t, bool> find_or_prepare_insert(Key const& key) {
+    if (auto const entry = find_entry(key); entry != nullptr) {
+      return {static_cast<std::size_t>(entry - entries()), false};
+    }
+    auto const h = Hash{}(key);
+    if (growth_left_ == 0U) {
+      // Grow if more than 25/32 full, otherwise only drop tombstones.
+      resize(size_ * 32U > capacity_ * 25U || capacity_ == 0U
+                 ? growth_to_capacity(size_ + 1U)
+                 : capacity_);
+    }
+    auto const i = find_first_non_full(h);
+    if (static_cast<ctrl_t const*>(ctrl_)[i] == hash_storage_detail::EMPTY) {
+      --growth_left_;
+    }
+    set_ctrl(i, hash_storage_detail::h2(h));
+    ++size_;
+    return {i, true};
+  }
+
+  std::size_t find_first_non_full(hash_t const h) const {
+    using namespace hash_storage_detail;
+    auto const ctrl = static_cast<ctrl_t const*>(ctrl_);
+    for (auto seq = probe_seq{h1(h), capacity_};; seq.next()) {
+      auto const m = group{ctrl + seq.offset_}.match_empty_or_deleted();
+      if (m != 0U) {
+        return seq.offset(trailing_zeros(m));
+      }
+    }
+  }
+
+  void set_ctrl(std::size_t const i, ctrl_t const c) {
+    using namespace hash_storage_detail;
+    auto const ctrl = static_cast<ctrl_t*>(ctrl_);
+    ctrl[i] = c;
+    ctrl[((i - CLONED_BYTES) & capacity_) + CLONED_BYTES] = c;
+  }
+
+  void erase_index(std::size_t const i) {
+    using namespace hash_storage_detail;
+    auto const ctrl = static_cast<ctrl_t const*>(ctrl_);
+
+    // EMPTY is only allowed if no probe sequence ever passed this slot
+    // with a full group, i.e. there is an empty slot within GROUP_WIDTH.
+    auto const before = (i - GROUP_WIDTH) & capacity_;
+    auto const empty_after = group{ctrl + i}.match_empty();
+    auto const empty_before = group{ctrl + before}.match_empty();
+    auto const was_never_full =
+        empty_before != 0U && empty_after != 0U &&
+        trailing_zeros(empty_after) + leading_zeros16(empty_before) <
+            GROUP_WIDTH;
+
+    entries()[i].~T();
+    std::memset(static_cast<void*>(entries() + i), 0, sizeof(T));
+    set_ctrl(i, was_never_full ? EMPTY : DELETED);
+    growth_left_ += was_never_full ? 1U : 0U;
+    --size_;
+  }
+
+  void resize(std::size_t const new_capacity) {
+    auto old = hash_storage{};
+    old.move_from(std::move(*this));
+
+    allocate(new_capacity);
+    if (old.capacity_ != 0U) {
+      auto const old_ctrl = static_cast<ctrl_t const*>(old.ctrl_);
+      for (auto i = std::size_t{0U}; i != old.capacity_; ++i) {
+        if (hash_storage_detail::is_full(old_ctrl[i])) {
+          auto& el = old.entries()[i];
+          auto const h = Hash{}(GetKey{}(el));
+          auto const target = find_first_non_full(h);
+          set_ctrl(target, hash_storage_detail::h2(h));
+          new (entries() + target) T{std::move(el)};
+        }
+      }
+      growth_left_ -= old.size_;
+      size_ = old.size_;
+    }
+  }
+
+  void allocate(std::size_t const capacity) {
+    auto const mem = std::malloc(memory_size(capacity));  // NOLINT
+    if (mem == nullptr) {
+      throw std::bad_alloc{};
+    }
+    std::memset(mem, 0, capacity * sizeof(T));
+    entries_ = static_cast<T*>(mem);
+    ctrl_ = reinterpret_cast<ctrl_t*>(static_cast<uint8_t*>(mem) +
+                                      capacity * sizeof(T));
+    capacity_ = static_cast<size_type>(capacity);
+    size_ = 0U;
+    growth_left_ = static_cast<size_type>(capacity_to_growth(capacity));
+    self_allocated_ = true;
+    reset_ctrl();
+  }
+
+  void reset_ctrl() {
+    using namespace hash_storage_detail;
+    auto const ctrl = static_cast<ctrl_t*>(ctrl_);
+    std::memset(ctrl, static_cast<uint8_t>(EMPTY),
+                capacity_ + 1U + CLONED_BYTES);
+    ctrl[capacity_] = END;
+  }
+
+  void destroy_entries() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      auto const ctrl = static_cast<ctrl_t const*>(ctrl_);
+      for (auto i = std::size_t{0U}; i != capacity_; ++i) {
+        if (hash_storage_detail::is_full(ctrl[i])) {
+          entries()[i].~T();
+        }
+      }
+    }
+  }
+
+  void deallocate() {
+    if (!self_allocated_ || capacity_ == 0U) {
+      return;
+    }
+    destroy_entries();
+    std::free(entries());  // NOLINT
+    entries_ = nullptr;
+    ctrl_ = nullptr;
+    size_ = 0U;
+    capacity_ = 0U;
+    growth_left_ = 0U;
+    self_allocated_ = false;
+  }
+
+  void copy_from(hash_storage const& o) {
+    reserve(o.size());
+    for (auto const& el : o) {
+      insert(el);
+    }
+  }
+
+  void move_from(hash_storage&& o) {
+    entries_ = o.entries_;
+    ctrl_ = o.ctrl_;
+    size_ = o.size_;
+    capacity_ = o.capacity_;
+    growth_left_ = o.growth_left_;
+    self_allocated_ = o.self_allocated_;
+    o.entries_ = nullptr;
+    o.ctrl_ = nullptr;
+    o.size_ = 0U;
+    o.capacity_ = 0U;
+    o.growth_left_ = 0U;
+    o.self_allocated_ = false;
+  }
+};
+
+}  // namespace cista
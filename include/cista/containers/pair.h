@@ -0,0 +1,26 @@
+#pragma once
+
+namespace cista {
+
+// Aggregate pair (std::pair is not an aggregate and can therefore not be
+// serialized by the generic reflection based serializer).
+template <typename T1, typename T2>
+struct pair {
+  using first_type = T1;
+  using second_type = T2;
+
+  T1 first{};
+  T2 second{};
+};
+
+template <typename T1, typename T2>
+inline bool operator==(pair<T1, T2> const& a, pair<T1, T2> const& b) {
+  return a.first == b.first && a.second == b.second;
+}
+
+template <typename T1, typename T2>
+inline bool operator!=(pair<T1, T2> const& a, pair<T1, T2> const& b) {
+  return !(a == b);
+}
+
+}  // namespace cista
@@ -4,14 +4,37 @@
 #include <cstring>
 #include <string>
 #include <string_view>
+#include <type_traits>
 
 #include "cista/containers/offset_ptr.h"
 
 namespace cista {
 
-template <typename Ptr = char const*>
+// SizeType: uint32_t limits long strings to 4 GB (16 byte header),
+// uint64_t lifts the limit (24 byte header, 23 chars stored inline).
+template <typename Ptr = char const*, typename SizeType = uint32_t>
 struct basic_string {
-  using msize_t = uint32_t;
+  static_assert(std::is_same_v<SizeType, uint32_t> ||
+                    std::is_same_v<SizeType, uint64_t>,
+                "basic_string: SizeType has to be uint32_t or uint64_t");
+
+  using msize_t = SizeType;
+
+  struct heap {
+    bool is_short_{false};
+    bool self_allocated_{false};
+    uint8_t __fill__[sizeof(SizeType) - 2U]{};
+    SizeType size_{0};
+    Ptr ptr_{nullptr};
+  };
+
+  // Strings of up to SHORT_LENGTH_LIMIT chars are stored inline.
+  static constexpr auto const SHORT_LENGTH_LIMIT = sizeof(heap) - 1U;
+
+  struct stack {
+    bool is_short_{true};
+    char s_[SHORT_LENGTH_LIMIT]{0};
+  };
 
   static msize_t mstrlen(char const* s) {
     return static_cast<msize_t>(std::strlen(s));
@@ -85,7 +108,7 @@ struct basic_string {
     if (len == 0) {
       return;
     }
-    s_.is_short_ = (len <= 15);
+    s_.is_short_ = (len <= SHORT_LENGTH_LIMIT);
     if (!s_.is_short_) {
       h_.ptr_ = static_cast<char*>(std::malloc(len));
       if (h_.ptr_ == nullptr) {
@@ -122,10 +145,10 @@ struct basic_string {
     if (str == nullptr || len == 0) {
       return;
     }
-    s_.is_short_ = (len <= 15);
+    s_.is_short_ = (len <= SHORT_LENGTH_LIMIT);
     if (s_.is_short_) {
       std::memcpy(s_.s_, str, len);
-      for (auto i = len; i < 15; ++i) {
+      for (auto i = len; i < SHORT_LENGTH_LIMIT; ++i) {
         s_.s_[i] = '\0';
       }
     } else {
@@ -155,7 +178,7 @@ struct basic_string {
       return;
     }
 
-    if (len <= 15) {
+    if (len <= SHORT_LENGTH_LIMIT) {
       return set_owning(str, len);
     }
 
@@ -210,9 +233,10 @@ struct basic_string {
 
   msize_t size() const {
     if (is_short()) {
-      auto const pos = static_cast<char const*>(std::memchr(s_.s_, '\0', 15));
+      auto const pos = static_cast<char const*>(
+          std::memchr(s_.s_, '\0', SHORT_LENGTH_LIMIT));
       if (pos == nullptr) {
-        return 15;
+        return static_cast<msize_t>(SHORT_LENGTH_LIMIT);
       } else {
         return static_cast<msize_t>(pos - s_.s_);
       }
@@ -221,20 +245,6 @@ struct basic_string {
     }
   }
 
-  struct heap {
-    bool is_short_{false};
-    bool self_allocated_{false};
-    uint8_t __fill_2__{0};
-    uint8_t __fill_3__{0};
-    uint32_t size_{0};
-    Ptr ptr_{nullptr};
-  };
-
-  struct stack {
-    bool is_short_{true};
-    char s_[15]{0};
-  };
-
   union {
     heap h_;
     stack s_;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cinttypes>
+#include <type_traits>
 
 #include "cista/containers/offset_ptr.h"
 
@@ -52,4 +53,14 @@ struct basic_unique_ptr {
   uint32_t __fill_2__{0};
 };
 
+template <typename T>
+struct is_unique_ptr_helper : std::false_type {};
+
+template <typename T, typename Ptr>
+struct is_unique_ptr_helper<basic_unique_ptr<T, Ptr>> : std::true_type {};
+
+template <typename T>
+constexpr bool is_unique_ptr_v =
+    is_unique_ptr_helper<std::remove_cv_t<T>>::value;
+
 }  // namespace cista
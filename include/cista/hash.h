@@ -18,10 +18,9 @@ constexpr hash_t hash_combine(hash_t const h, T const val) {
   return (h ^ static_cast<hash_t>(val)) * prime;
 }
 
-inline hash_t hash(std::string_view s, hash_t h = BASE_HASH) {
-  auto const ptr = reinterpret_cast<uint8_t const*>(s.data());
+constexpr hash_t hash(std::string_view s, hash_t h = BASE_HASH) {
   for (auto i = size_t{0ULL}; i < s.size(); ++i) {
-    h = hash_combine(h, ptr[i]);
+    h = hash_combine(h, static_cast<uint8_t>(s[i]));
   }
   return h;
 }
@@ -33,8 +32,20 @@ constexpr hash_t hash(const char (&str)[N], hash_t const h = BASE_HASH) {
 
 template <typename T>
 constexpr uint64_t hash(T const& buf, hash_t const h = BASE_HASH) {
-  return hash(
-      std::string_view{reinterpret_cast<char const*>(&buf[0]), buf.size()}, h);
+  return hash(std::string_view{reinterpret_cast<char const*>(buf.data()),
+                               buf.size()},
+              h);
 }
 
+// Streaming interface (same as wide_hasher) for checksums computed in chunks.
+struct fnv1a_hasher {
+  void update(void const* data, std::size_t const size) {
+    h_ = hash(std::string_view{static_cast<char const*>(data), size}, h_);
+  }
+  void update(std::string_view const s) { h_ = hash(s, h_); }
+  hash_t finish() const { return h_; }
+
+  hash_t h_{BASE_HASH};
+};
+
 }  // namespace cista
\ No newline at end of file
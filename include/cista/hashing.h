@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "cista/hash.h"
+
+namespace cista {
+
+// Hash functions of the hash_map / hash_set containers.
+// The hash values are stored implicitly (slot positions) in serialized
+// containers. Therefore, they have to be identical on every platform and
+// in every process: std::hash can not be used.
+// String-like keys (std::string, std::string_view, cista strings,
+// char const*) produce the same hash for the same characters, which
+// allows lookups with std::string_view in maps with cista string keys.
+namespace hashing_detail {
+
+// Finalizer of MurmurHash3.
+constexpr uint64_t mix(uint64_t h) {
+  h ^= h >> 33U;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33U;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33U;
+  return h;
+}
+
+inline uint64_t read_le(uint8_t const* p, std::size_t const n) {
+  auto w = uint64_t{0U};
+  for (auto i = std::size_t{0U}; i != n; ++i) {
+    w |= static_cast<uint64_t>(p[i]) << (8U * i);
+  }
+  return w;
+}
+
+template <typename T, typename = void>
+struct is_string_like : std::false_type {};
+
+template <typename T>
+struct is_string_like<
+    T, std::void_t<decltype(std::string_view{std::declval<T const&>().data(),
+                                             std::declval<T const&>().size()})>>
+    : std::true_type {};
+
+template <typename T>
+constexpr auto const is_string_like_v =
+    is_string_like<T>::value || std::is_same_v<T, char const*> ||
+    std::is_same_v<T, char*>;
+
+template <typename T>
+std::string_view to_string_view(T const& s) {
+  if constexpr (std::is_pointer_v<std::decay_t<T>>) {
+    return std::string_view{s};
+  } else {
+    return std::string_view{s.data(), s.size()};
+  }
+}
+
+}  // namespace hashing_detail
+
+inline hash_t hash_bytes(std::string_view const s) {
+  using namespace hashing_detail;
+  constexpr auto const K = uint64_t{0x9E3779B97F4A7C15ULL};
+  auto const p = reinterpret_cast<uint8_t const*>(s.data());
+  auto h = static_cast<uint64_t>(s.size()) * K;
+  auto i = std::size_t{0U};
+  for (; i + 8U <= s.size(); i += 8U) {
+    h = mix(h ^ read_le(p + i, 8U)) * K;
+  }
+  if (i != s.size()) {
+    h = mix(h ^ read_le(p + i, s.size() - i)) * K;
+  }
+  return mix(h);
+}
+
+template <typename Key>
+struct hashing {
+  template <typename T>
+  hash_t operator()(T const& el) const {
+    using Type = std::decay_t<T>;
+    if constexpr (hashing_detail::is_string_like_v<Type>) {
+      return hash_bytes(hashing_detail::to_string_view(el));
+    } else if constexpr (std::is_enum_v<Type>) {
+      return hashing_detail::mix(static_cast<uint64_t>(
+          static_cast<std::underlying_type_t<Type>>(el)));
+    } else if constexpr (std::is_floating_point_v<Type> ||
+                         (std::is_arithmetic_v<Type> &&
+                          std::is_floating_point_v<Key>)) {
+      // Convert first: lookups with other arithmetic types find the same
+      // key. The bits are read through a same-size unsigned integer to get
+      // the same value regardless of the byte order.
+      using Float =
+          std::conditional_t<std::is_floating_point_v<Key>, Key, Type>;
+      static_assert(sizeof(Float) == sizeof(uint32_t) ||
+                        sizeof(Float) == sizeof(uint64_t),
+                    "unsupported floating point type");
+      using Bits = std::conditional_t<sizeof(Float) == sizeof(uint32_t),
+                                      uint32_t, uint64_t>;
+      auto const value = static_cast<Float>(el);
+      auto const normalized =
+          value == Float{0} ? Float{0} : value;  // -0.0 == 0.0
+      auto bits = Bits{0U};
+      std::memcpy(&bits, &normalized, sizeof(bits));
+      return hashing_detail::mix(static_cast<uint64_t>(bits));
+    } else if constexpr (std::is_integral_v<Type> &&
+                         std::is_integral_v<Key>) {
+      // Convert first: lookups with other integer types find the same key.
+      return hashing_detail::mix(static_cast<uint64_t>(static_cast<Key>(el)));
+    } else if constexpr (std::is_integral_v<Type>) {
+      return hashing_detail::mix(static_cast<uint64_t>(el));
+    } else {
+      return el.hash();
+    }
+  }
+};
+
+template <typename Key>
+struct equal_to {
+  template <typename A, typename B>
+  bool operator()(A const& a, B const& b) const {
+    using namespace hashing_detail;
+    if constexpr (is_string_like_v<std::decay_t<A>> &&
+                  is_string_like_v<std::decay_t<B>>) {
+      return to_string_view(a) == to_string_view(b);
+    } else {
+      return a == b;
+    }
+  }
+};
+
+}  // namespace cista
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include "cista/verify.h"
+
+namespace cista {
+
+// Fast LZ77 block codec (LZ4 style sequences) used by compression.h.
+// A compressed block is a list of sequences:
+//
+//   [token][literal length+][literals][offset (2 bytes LE)][match length+]
+//
+// The upper / lower four bits of the token hold the literal length and
+// the match length minus MIN_MATCH. The value 15 is followed by bytes
+// that are added until a byte != 255. The last sequence ends after its
+// literals (no offset, no match).
+namespace lz_detail {
+
+constexpr auto const MIN_MATCH = std::size_t{4U};
+constexpr auto const MAX_DISTANCE = std::size_t{65535U};
+constexpr auto const HASH_BITS = 14U;
+constexpr auto const SKIP_TRIGGER = 6U;
+
+inline uint32_t read32(uint8_t const* p) {
+  auto v = uint32_t{};
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t hash4(uint32_t const v) {
+  return (v * 2654435761U) >> (32U - HASH_BITS);
+}
+
+inline uint8_t* write_length(uint8_t* out, std::size_t length) {
+  for (length -= 15U; length >= 255U; length -= 255U) {
+    *out++ = 255U;
+  }
+  *out++ = static_cast<uint8_t>(length);
+  return out;
+}
+
+inline std::size_t read_length(uint8_t const*& in, uint8_t const* end) {
+  auto length = std::size_t{15U};
+  auto b = uint8_t{255U};
+  while (b == 255U) {
+    verify(in != end, "lz: truncated length");
+    b = *in++;
+    length += b;
+  }
+  return length;
+}
+
+inline uint8_t* write_sequence(uint8_t* out, uint8_t const* literals,
+                               std::size_t const literal_length,
+                               std::size_t const distance,
+                               std::size_t const match_length) {
+  auto const match_code = match_length == 0U ? 0U : match_length - MIN_MATCH;
+  auto& token = *out++;
+  token = static_cast<uint8_t>((std::min(literal_length, std::size_t{15U})
+                                << 4U) |
+                               std::min(match_code, std::size_t{15U}));
+  if (literal_length >= 15U) {
+    out = write_length(out, literal_length);
+  }
+  if (literal_length != 0U) {
+    std::memcpy(out, literals, literal_length);
+    out += literal_length;
+  }
+  if (match_length != 0U) {
+    *out++ = static_cast<uint8_t>(distance & 0xFFU);
+    *out++ = static_cast<uint8_t>(distance >> 8U);
+    if (match_code >= 15U) {
+      out = write_length(out, match_code);
+    }
+  }
+  return out;
+}
+
+}  // namespace lz_detail
+
+// Output buffer size sufficient for lz_compress() of n bytes.
+constexpr std::size_t lz_compress_bound(std::size_t const n) {
+  return n + n / 255U + 16U;
+}
+
+// Compresses [in, in + n[ to out (lz_compress_bound(n) bytes).
+// Returns the compressed size.
+inline std::size_t lz_compress(uint8_t const* in, std::size_t const n,
+                               uint8_t* out) {
+  using namespace lz_detail;
+
+  // Position + 1 of the last occurrence of each hashed 4 byte sequence.
+  auto table = std::vector<uint32_t>(std::size_t{1U} << HASH_BITS);
+  auto const begin = out;
+  auto anchor = std::size_t{0U};
+  auto i = std::size_t{0U};
+  while (i + MIN_MATCH <= n) {
+    auto const v = read32(in + i);
+    auto& slot = table[hash4(v)];
+    auto const candidate = static_cast<std::size_t>(slot);
+    slot = static_cast<uint32_t>(i + 1U);
+
+    if (candidate == 0U || i - (candidate - 1U) > MAX_DISTANCE ||
+        read32(in + candidate - 1U) != v) {
+      // Incompressible data is skipped faster the longer no match is found.
+      i += 1U + ((i - anchor) >> SKIP_TRIGGER);
+      continue;
+    }
+
+    auto const match = candidate - 1U;
+    auto length = MIN_MATCH;
+    while (i + length != n && in[match + length] == in[i + length]) {
+      ++length;
+    }
+    out = write_sequence(out, in + anchor, i - anchor, i - match, length);
+    i += length;
+    anchor = i;
+    if (i + MIN_MATCH <= n && i >= 2U) {
+      table[hash4(read32(in + i - 2U))] = static_cast<uint32_t>(i - 1U);
+    }
+  }
+  out = write_sequence(out, in + anchor, n - anchor, 0U, 0U);
+  return static_cast<std::size_t>(out - begin);
+}
+
+// Decompresses [in, in + n[ to exactly out_size bytes at out.
+// Throws on corrupt input (never reads / writes out of bounds).
+inline void lz_decompress(uint8_t const* in, std::size_t const n,
+                          uint8_t* out, std::size_t const out_size) {
+  using namespace lz_detail;
+
+  auto const in_end = in + n;
+  auto const out_begin = out;
+  auto const out_end = out + out_size;
+  for (;;) {
+    verify(in != in_end, "lz: truncated sequence");
+    auto const token = *in++;
+
+    auto literal_length = static_cast<std::size_t>(token >> 4U);
+    if (literal_length == 15U) {
+      literal_length = read_length(in, in_end);
+    }
+    verify(literal_length <= static_cast<std::size_t>(in_end - in) &&
+               literal_length <= static_cast<std::size_t>(out_end - out),
+           "lz: literals out of bounds");
+    if (literal_length != 0U) {
+      std::memcpy(out, in, literal_length);
+      in += literal_length;
+      out += literal_length;
+    }
+
+    if (in == in_end) {
+      break;
+    }
+
+    verify(in_end - in >= 2, "lz: truncated offset");
+    auto const distance = static_cast<std::size_t>(in[0]) |
+                          (static_cast<std::size_t>(in[1]) << 8U);
+    in += 2;
+    auto match_length = static_cast<std::size_t>(token & 0xFU);
+    if (match_length == 15U) {
+      match_length = read_length(in, in_end);
+    }
+    match_length += MIN_MATCH;
+    verify(distance != 0U &&
+               distance <= static_cast<std::size_t>(out - out_begin) &&
+               match_length <= static_cast<std::size_t>(out_end - out),
+           "lz: match out of bounds");
+
+    auto const match = out - distance;
+    if (distance >= match_length) {
+      std::memcpy(out, match, match_length);
+    } else {
+      for (auto j = std::size_t{0U}; j != match_length; ++j) {
+        out[j] = match[j];
+      }
+    }
+    out += match_length;
+  }
+  verify(out == out_end, "lz: size mismatch");
+}
+
+}  // namespace cista
@@ -15,6 +15,10 @@
 #include <unistd.h>
 #endif
 
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
 #include "cista/next_power_of_2.h"
 #include "cista/targets/file.h"
 
@@ -23,13 +27,48 @@ namespace cista {
 struct mmap {
   static constexpr auto const OFFSET = 0ULL;
   static constexpr auto const ENTIRE_FILE = std::numeric_limits<size_t>::max();
-  enum class protection { READ, WRITE };
+  // PRIVATE: writable copy-on-write mapping, the file is not modified
+  // (e.g. for raw mode deserialization of a read-only snapshot).
+  enum class protection { READ, WRITE, PRIVATE };
+
+  // Expected access pattern (madvise). No-op on Windows.
+  enum class advice { NORMAL, SEQUENTIAL, RANDOM, WILLNEED, DONTNEED };
+
+  enum class flags : unsigned {
+    NONE = 0U,
+    POPULATE = 1U << 0U,  // fault in all pages when mapping (Linux)
+    HUGE_PAGES = 1U << 1U  // transparent huge pages if available (Linux)
+  };
+
+  friend constexpr flags operator|(flags const a, flags const b) {
+    return flags{static_cast<std::underlying_type_t<flags>>(a) |
+                 static_cast<std::underlying_type_t<flags>>(b)};
+  }
+
+  friend constexpr flags operator&(flags const a, flags const b) {
+    return flags{static_cast<std::underlying_type_t<flags>>(a) &
+                 static_cast<std::underlying_type_t<flags>>(b)};
+  }
+
+  explicit mmap(char const* path, protection const prot = protection::WRITE,
+                flags const f = flags::NONE)
+      : f_{path, prot == protection::WRITE ? "w+" : "r"},
+        prot_{prot},
+        flags_{f},
+        size_{f_.size()},
+        used_size_{f_.size()},
+        mapped_size_{size_},
+        addr_{size_ == 0U ? nullptr : map()} {}
 
-  explicit mmap(char const* path, protection const prot = protection::WRITE)
-      : f_{path, prot == protection::READ ? "r" : "w+"},
+  // Maps an already opened file (e.g. shared memory, see shared_memory.h).
+  explicit mmap(file&& f, protection const prot = protection::WRITE,
+                flags const fl = flags::NONE)
+      : f_{std::move(f)},
         prot_{prot},
+        flags_{fl},
         size_{f_.size()},
         used_size_{f_.size()},
+        mapped_size_{size_},
         addr_{size_ == 0U ? nullptr : map()} {}
 
   ~mmap() {
@@ -49,8 +88,10 @@ struct mmap {
   mmap(mmap&& o)
       : f_{std::move(o.f_)},
         prot_{o.prot_},
+        flags_{o.flags_},
         size_{o.size_},
         used_size_{o.used_size_},
+        mapped_size_{o.mapped_size_},
         addr_{o.addr_} {
     o.addr_ = nullptr;
   }
@@ -58,8 +99,10 @@ struct mmap {
   mmap& operator=(mmap&& o) {
     f_ = std::move(o.f_);
     prot_ = o.prot_;
+    flags_ = o.flags_;
     size_ = o.size_;
     used_size_ = o.used_size_;
+    mapped_size_ = o.mapped_size_;
     addr_ = o.addr_;
     o.addr_ = nullptr;
     return *this;
@@ -91,8 +134,81 @@ struct mmap {
     }
   }
 
+  // Truncates the file to size(). The mapping stays valid up to size().
+  void shrink_to_fit() {
+    verify(prot_ == protection::WRITE, "read-only not resizable");
+    if (size_ == used_size_) {
+      return;
+    }
+#ifdef _MSC_VER
+    unmap();
+    size_ = used_size_;
+    mapped_size_ = size_;
+    resize_file();
+    addr_ = size_ == 0U ? nullptr : map();
+#else
+    size_ = used_size_;
+    resize_file();
+#endif
+  }
+
+  // Reserves virtual address space for a file of up to n bytes without
+  // growing the file. Growing the file within this range never moves the
+  // mapping (pointers into data() stay valid). No-op on Windows where a
+  // mapping cannot be larger than the file.
+  void reserve_address_space(size_t const n) {
+    verify(prot_ == protection::WRITE, "read-only not resizable");
+#ifndef _MSC_VER
+    if (mapped_size_ < n) {
+      remap(n);
+    }
+#else
+    (void)n;
+#endif
+  }
+
+  // Access pattern hint for [offset, offset + len[ (default: entire file).
+  void advise(advice const a, size_t const offset = 0U,
+              size_t const len = ENTIRE_FILE) {
+#ifdef _MSC_VER
+    (void)a;
+    (void)offset;
+    (void)len;
+#else
+    auto const posix_advice = [&]() {
+      switch (a) {
+        case advice::SEQUENTIAL: return MADV_SEQUENTIAL;
+        case advice::RANDOM: return MADV_RANDOM;
+        case advice::WILLNEED: return MADV_WILLNEED;
+        case advice::DONTNEED: return MADV_DONTNEED;
+        case advice::NORMAL: [[fallthrough]];
+        default: return MADV_NORMAL;
+      }
+    }();
+    madvise_range(posix_advice, offset, len);
+#endif
+  }
+
+  // Starts asynchronous read-ahead of [offset, offset + len[, e.g. to warm
+  // the pages of a subtree before traversing it.
+  void prefetch(size_t const offset, size_t const len) {
+    advise(advice::WILLNEED, offset, len);
+  }
+
+  // Releases the pages that lie entirely within [offset, offset + len[
+  // (e.g. a page aligned vector that is not needed anymore). Shared
+  // mappings read them again from the file on the next access, changes of
+  // PRIVATE mappings to them are lost.
+  void drop(size_t const offset, size_t const len) {
+    advise(advice::DONTNEED, offset, len);
+  }
+
   size_t size() const { return used_size_; }
 
+#ifndef _MSC_VER
+  int fd() const { return f_.fd(); }
+#endif
+
   inline uint8_t* data() { return static_cast<unsigned char*>(addr_); }
   inline uint8_t const* data() const {
     return static_cast<unsigned char const*>(addr_);
@@ -118,7 +234,7 @@ private:
     }
 #else
     if (addr_ != nullptr) {
-      ::munmap(addr_, size_);
+      ::munmap(addr_, mapped_size_);
       addr_ = nullptr;
     }
 #endif
@@ -130,28 +246,99 @@ private:
     auto const size_low = static_cast<DWORD>(size_);
     auto const size_high = static_cast<DWORD>(size_ >> 32);
     const auto fm = ::CreateFileMapping(
-        f_.f_, 0, prot_ == protection::READ ? PAGE_READONLY : PAGE_READWRITE,
+        f_.f_, 0,
+        prot_ == protection::READ
+            ? PAGE_READONLY
+            : (prot_ == protection::PRIVATE ? PAGE_WRITECOPY : PAGE_READWRITE),
         size_high, size_low, 0);
     verify(fm != INVALID_HANDLE_VALUE, "file mapping error");
     file_mapping_ = fm;
 
     auto const addr = ::MapViewOfFile(
-        fm, prot_ == protection::READ ? FILE_MAP_READ : FILE_MAP_WRITE, OFFSET,
-        OFFSET, size_);
+        fm,
+        prot_ == protection::READ
+            ? FILE_MAP_READ
+            : (prot_ == protection::PRIVATE ? FILE_MAP_COPY : FILE_MAP_WRITE),
+        OFFSET, OFFSET, size_);
     verify(addr != nullptr, "map error");
 
     return addr;
 #else
-    auto const addr = ::mmap(nullptr, size_,
-                             prot_ == protection::READ ? PROT_READ : PROT_WRITE,
-                             MAP_SHARED, f_.fd(), OFFSET);
-    verify(addr != nullptr, "map error");
+    auto map_flags = prot_ == protection::PRIVATE ? MAP_PRIVATE : MAP_SHARED;
+#ifdef MAP_POPULATE
+    if ((flags_ & flags::POPULATE) == flags::POPULATE) {
+      map_flags |= MAP_POPULATE;
+    }
+#endif
+    auto const addr = ::mmap(nullptr, mapped_size_,
+                             prot_ == protection::READ
+                                 ? PROT_READ
+                                 : (prot_ == protection::PRIVATE
+                                        ? PROT_READ | PROT_WRITE
+                                        : PROT_WRITE),
+                             map_flags, f_.fd(), OFFSET);
+    verify(addr != MAP_FAILED, "map error");
+#ifdef MADV_HUGEPAGE
+    if ((flags_ & flags::HUGE_PAGES) == flags::HUGE_PAGES) {
+      // Only a hint: fails if the kernel has no transparent huge pages.
+      ::madvise(addr, mapped_size_, MADV_HUGEPAGE);
+    }
+#endif
     return addr;
 #endif
   }
 
+#ifndef _MSC_VER
+  void madvise_range(int const advice, size_t const offset, size_t len) {
+    if (addr_ == nullptr || offset >= size_) {
+      return;
+    }
+    len = std::min(len, size_ - offset);
+
+    // madvise() requires a page aligned start address. Hints are widened
+    // to whole pages. DONTNEED is narrowed to the pages that lie entirely
+    // within the range: it would discard changes (PRIVATE) to neighbouring
+    // data sharing the first / last page.
+    auto const page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    auto start = offset - offset % page_size;
+    auto end = offset + len;
+    if (advice == MADV_DONTNEED) {
+      start = offset == start ? start : start + page_size;
+      end -= end % page_size;
+      if (end <= start) {
+        return;
+      }
+    }
+
+    verify(::madvise(data() + start, end - start, advice) == 0,
+           "madvise error");
+  }
+#endif
+
+#ifndef _MSC_VER
+  // Grows the mapping to n bytes. Pages beyond the end of the file are
+  // reserved address space and may only be accessed after growing the file.
+  void remap(size_t const n) {
+    if (addr_ == nullptr) {
+      mapped_size_ = n;
+      addr_ = map();
+      return;
+    }
+#ifdef __linux__
+    auto const addr = ::mremap(addr_, mapped_size_, n, MREMAP_MAYMOVE);
+    verify(addr != MAP_FAILED, "remap error");
+    addr_ = addr;
+    mapped_size_ = n;
+#else
+    unmap();
+    mapped_size_ = n;
+    addr_ = map();
+#endif
+  }
+#endif
+
   void resize_file() {
-    if (prot_ == protection::READ) {
+    if (prot_ != protection::WRITE) {
       return;
     }
 
@@ -171,20 +358,31 @@ private:
   }
 
   void resize_map(size_t const new_size) {
-    if (prot_ == protection::READ) {
+    if (prot_ != protection::WRITE) {
       return;
     }
 
+#ifdef _MSC_VER
     unmap();
     size_ = new_size;
+    mapped_size_ = new_size;
     resize_file();
     addr_ = map();
+#else
+    size_ = new_size;
+    resize_file();
+    if (addr_ == nullptr || mapped_size_ < size_) {
+      remap(size_);
+    }
+#endif
   }
 
   file f_;
   protection prot_;
-  size_t size_;
+  flags flags_;
+  size_t size_;  // file size
   size_t used_size_;
+  size_t mapped_size_;  // >= size_ (reserved address space)
   void* addr_;
 #ifdef _MSC_VER
   HANDLE file_mapping_;
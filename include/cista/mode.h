@@ -9,7 +9,18 @@ enum class mode {
   UNCHECKED = 1U << 0U,
   WITH_VERSION = 1U << 1U,
   WITH_INTEGRITY = 1U << 2U,
-  SERIALIZE_BIG_ENDIAN = 1U << 3U
+  SERIALIZE_BIG_ENDIAN = 1U << 3U,
+  WITH_RELOCATIONS = 1U << 4U,  // UNCHECKED: pointers from a table, no walk
+  WIDE_CHECKSUM = 1U << 5U,  // WITH_INTEGRITY: wide_hash instead of FNV-1a
+  CHUNKED_CHECKSUM = 1U << 6U,  // WITH_INTEGRITY: parallel verifiable
+  // WITH_INTEGRITY: word_hash while writing instead of a final read pass.
+  // Slower than WIDE_CHECKSUM if the output stays in the page cache.
+  INCREMENTAL_CHECKSUM = 1U << 7U,
+  BLOCK_CHECKSUMS = 1U << 8U,  // checksum table for lazy per block verification
+  DEDUPLICATE_STRINGS = 1U << 9U,  // identical long strings are written once
+  DEDUPLICATE_BLOCKS = 1U << 10U,  // same for pointer-free vectors/unique_ptrs
+  BREADTH_FIRST_LAYOUT = 1U << 11U,  // unique_ptr targets level by level
+  PAGE_ALIGN_LARGE_VECTORS = 1U << 12U  // see LARGE_VECTOR_SIZE
 };
 
 constexpr mode operator|(mode const& a, mode const& b) {
@@ -10,7 +10,7 @@ constexpr TemplateSizeType next_power_of_two(TemplateSizeType n) {
   n |= n >> 4U;
   n |= n >> 8U;
   n |= n >> 16U;
-  if constexpr (sizeof(TemplateSizeType) > 32U) {
+  if constexpr (sizeof(TemplateSizeType) > 4U) {
     n |= n >> 32U;
   }
   n++;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cinttypes>
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace cista {
+
+inline unsigned hardware_parallelism() {
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+// Splits [0, n[ into at most `parallelism` contiguous chunks and calls
+// fn(from, to) for every chunk concurrently. The calling thread processes
+// the first chunk. The first exception thrown by a worker is rethrown.
+template <typename Fn>
+void parallel_for(unsigned const parallelism, std::size_t const n, Fn&& fn) {
+  auto const chunks = std::max(
+      std::size_t{1U}, std::min(static_cast<std::size_t>(parallelism), n));
+  auto const chunk_size = (n + chunks - 1U) / chunks;
+
+  std::vector<std::future<void>> workers;
+  workers.reserve(chunks - 1U);
+  for (auto i = std::size_t{1U}; i < chunks; ++i) {
+    auto const from = std::min(n, i * chunk_size);
+    auto const to = std::min(n, from + chunk_size);
+    workers.emplace_back(
+        std::async(std::launch::async, [&fn, from, to]() { fn(from, to); }));
+  }
+
+  fn(std::size_t{0U}, std::min(n, chunk_size));
+
+  for (auto& w : workers) {
+    w.get();
+  }
+}
+
+}  // namespace cista
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+#include "cista/next_power_of_2.h"
+#include "cista/verify.h"
+
+namespace cista {
+
+// Flat open addressing (linear probing) hash table from pointers to values.
+// The nullptr key marks empty slots and can therefore not be stored.
+template <typename Value>
+struct pointer_map {
+  struct entry {
+    void const* key_{nullptr};
+    Value value_{};
+  };
+
+  static constexpr auto const MIN_CAPACITY = std::size_t{16U};
+
+  Value const* find(void const* key) const {
+    if (entries_.empty()) {
+      return nullptr;
+    }
+    for (auto i = slot(key);; i = (i + 1U) & mask()) {
+      auto const& e = entries_[i];
+      if (e.key_ == key) {
+        return &e.value_;
+      } else if (e.key_ == nullptr) {
+        return nullptr;
+      }
+    }
+  }
+
+  Value* find(void const* key) {
+    return const_cast<Value*>(static_cast<pointer_map const*>(this)->find(key));
+  }
+
+  Value& operator[](void const* key) {
+    verify(key != nullptr, "pointer_map: nullptr key");
+    if (needs_growth(size_ + 1U)) {
+      rehash(entries_.empty() ? MIN_CAPACITY : entries_.size() * 2U);
+    }
+    for (auto i = slot(key);; i = (i + 1U) & mask()) {
+      auto& e = entries_[i];
+      if (e.key_ == key) {
+        return e.value_;
+      } else if (e.key_ == nullptr) {
+        e.key_ = key;
+        ++size_;
+        return e.value_;
+      }
+    }
+  }
+
+  void reserve(std::size_t const n) {
+    auto capacity = entries_.empty() ? MIN_CAPACITY : entries_.size();
+    while (needs_growth(n, capacity)) {
+      capacity *= 2U;
+    }
+    if (capacity != entries_.size()) {
+      rehash(capacity);
+    }
+  }
+
+  void clear() {
+    entries_.clear();
+    size_ = 0U;
+  }
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0U; }
+
+private:
+  static std::uint64_t hash(void const* key) {
+    // Finalizer of MurmurHash3: pointers are aligned and close together,
+    // so the low bits alone would produce long probe sequences.
+    auto h = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(key));
+    h ^= h >> 33U;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33U;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33U;
+    return h;
+  }
+
+  std::size_t mask() const { return entries_.size() - 1U; }
+
+  std::size_t slot(void const* key) const {
+    return static_cast<std::size_t>(hash(key)) & mask();
+  }
+
+  bool needs_growth(std::size_t const n) const {
+    return needs_growth(n, entries_.size());
+  }
+
+  static bool needs_growth(std::size_t const n, std::size_t const capacity) {
+    // Maximum load factor: 3/4
+    return n * 4U > capacity * 3U;
+  }
+
+  void rehash(std::size_t const capacity) {
+    auto old = std::move(entries_);
+    entries_ = std::vector<entry>(next_power_of_two(capacity));
+    for (auto& e : old) {
+      if (e.key_ != nullptr) {
+        auto i = slot(e.key_);
+        while (entries_[i].key_ != nullptr) {
+          i = (i + 1U) & mask();
+        }
+        entries_[i] = std::move(e);
+      }
+    }
+  }
+
+  std::vector<entry> entries_;
+  std::size_t size_{0U};
+};
+
+}  // namespace cista
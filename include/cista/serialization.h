@@ -1,21 +1,37 @@
 #pragma once
 
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <limits>
-#include <map>
+#include <memory>
+#include <queue>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "cista/block_checksum.h"
+#include "cista/chunked_hash.h"
 #include "cista/containers.h"
 #include "cista/decay.h"
 #include "cista/endian/conversion.h"
 #include "cista/hash.h"
 #include "cista/mode.h"
 #include "cista/offset_t.h"
+#include "cista/parallel_for.h"
+#include "cista/pointer_map.h"
 #include "cista/reflection/for_each_field.h"
 #include "cista/serialized_size.h"
 #include "cista/targets/buf.h"
+#include "cista/targets/buffered_file.h"
+#include "cista/targets/byte_counter.h"
 #include "cista/targets/file.h"
 #include "cista/type_hash/type_hash.h"
 #include "cista/verify.h"
+#include "cista/wide_hash.h"
+#include "cista/word_hash.h"
 
 #ifndef cista_member_offset
 #define cista_member_offset(s, m) (static_cast<cista::offset_t>(offsetof(s, m)))
@@ -31,9 +47,78 @@ struct pending_offset {
   offset_t pos_;
 };
 
+// Hash function of the WITH_INTEGRITY checksum (of each chunk if chunked).
+template <mode const Mode>
+using integrity_base_hasher_t =
+    std::conditional_t<(Mode & mode::WIDE_CHECKSUM) == mode::WIDE_CHECKSUM,
+                       wide_hasher, fnv1a_hasher>;
+
+// Streaming hasher computing the WITH_INTEGRITY checksum.
+template <mode const Mode>
+struct integrity_hasher {
+  static_assert((Mode & mode::INCREMENTAL_CHECKSUM) == mode::NONE ||
+                    (Mode & (mode::WIDE_CHECKSUM | mode::CHUNKED_CHECKSUM)) ==
+                        mode::NONE,
+                "INCREMENTAL_CHECKSUM cannot be combined with WIDE_CHECKSUM "
+                "or CHUNKED_CHECKSUM");
+
+  using type = std::conditional_t<
+      (Mode & mode::INCREMENTAL_CHECKSUM) == mode::INCREMENTAL_CHECKSUM,
+      word_hasher,
+      std::conditional_t<(Mode & mode::CHUNKED_CHECKSUM) ==
+                             mode::CHUNKED_CHECKSUM,
+                         chunked_hasher<integrity_base_hasher_t<Mode>>,
+                         integrity_base_hasher_t<Mode>>>;
+};
+
+template <mode const Mode>
+using integrity_hasher_t = typename integrity_hasher<Mode>::type;
+
+// Targets that maintain the word_hash while writing (see buf<>).
+template <typename Target, typename = void>
+struct has_incremental_checksum : std::false_type {};
+
+template <typename Target>
+struct has_incremental_checksum<
+    Target, std::void_t<decltype(std::declval<Target&>().incremental_checksum(
+                offset_t{}))>> : std::true_type {};
+
+// Layout of unique_ptr targets. By default, they are written depth first
+// (where the traversal reaches them). With mode::BREADTH_FIRST_LAYOUT,
+// they are queued and written level by level after their owner. A
+// layout_priority(T const&) function found by ADL orders the queue:
+// lower priorities are written first, equal ones breadth first.
+template <typename T, typename = void>
+struct has_layout_priority : std::false_type {};
+
+template <typename T>
+struct has_layout_priority<
+    T, std::void_t<decltype(layout_priority(std::declval<T const&>()))>>
+    : std::true_type {};
+
+// Returned by serialize().
+struct serialization_stats {
+  // DEDUPLICATE_STRINGS: long strings not written again.
+  std::size_t deduplicated_strings_{0U};
+  // DEDUPLICATE_BLOCKS: vector / unique_ptr payloads not written again.
+  std::size_t deduplicated_blocks_{0U};
+  // Sum of the sizes of the deduplicated strings and blocks.
+  std::size_t deduplicated_bytes_{0U};
+};
+
+// Placeholder for serialization_context members the mode does not use.
+struct unused_member {};
+
 template <typename Target, mode Mode>
 struct serialization_context {
   static constexpr auto const MODE = Mode;
+  static constexpr auto const DEDUPLICATE =
+      (Mode & (mode::DEDUPLICATE_STRINGS | mode::DEDUPLICATE_BLOCKS)) !=
+      mode::NONE;
+  static constexpr auto const DEFER =
+      (Mode & mode::BREADTH_FIRST_LAYOUT) == mode::BREADTH_FIRST_LAYOUT;
+  static constexpr auto const RELOCATIONS =
+      (Mode & mode::WITH_RELOCATIONS) == mode::WITH_RELOCATIONS;
 
   explicit serialization_context(Target& t) : t_{t} {}
 
@@ -47,25 +132,418 @@ struct serialization_context {
     t_.write(static_cast<std::size_t>(pos), val);
   }
 
-  uint64_t checksum(offset_t const from) const { return t_.checksum(from); }
+  uint64_t checksum(offset_t const from) const {
+    using hasher_t = integrity_hasher_t<Mode>;
+    if constexpr (std::is_same_v<hasher_t, word_hasher> &&
+                  has_incremental_checksum<Target>::value) {
+      return t_.incremental_checksum(from);
+    } else if constexpr (std::is_same_v<hasher_t, fnv1a_hasher>) {
+      return t_.checksum(from);
+    } else {
+      return t_.template checksum<hasher_t>(from);
+    }
+  }
+
+  // Hashes of the BLOCK_CHECKSUM_SIZE blocks of [from, to[.
+  std::vector<hash_t> block_checksums(offset_t const from,
+                                      offset_t const to) const {
+    auto h = block_hasher<integrity_base_hasher_t<Mode>>{
+        static_cast<std::size_t>(to - from)};
+    t_.update_hash(h, from);
+    return h.finish();
+  }
+
+  // Writes the block unless an identical block has been written before
+  // (at a position matching the alignment). Returns its position and
+  // whether it was deduplicated. Deduplicated data is shared: all
+  // references see the same bytes after deserialization.
+  std::pair<offset_t, bool> write_deduplicated(
+      void const* ptr, std::size_t const size,
+      std::size_t const alignment = 0) {
+    auto const [it, inserted] = blocks_.emplace(
+        std::string_view{static_cast<char const*>(ptr), size}, 0);
+    if (!inserted &&
+        (alignment == 0U ||
+         it->second % static_cast<offset_t>(alignment) == 0)) {
+      stats_.deduplicated_bytes_ += size;
+      return {it->second, true};
+    }
+    it->second = write(ptr, size, alignment);
+    return {it->second, false};
+  }
+
+  // BREADTH_FIRST_LAYOUT: fn(ctx, origin, pos) writes a queued object.
+  // Objects without layout_priority() go to a plain FIFO (priority 0).
+  // The heap is only used for types with a layout_priority() function.
+  struct deferred {
+    using fn_t = void (*)(serialization_context&, void const*, offset_t);
+
+    friend bool operator<(deferred const& a, deferred const& b) {
+      // std::priority_queue pops the greatest element first.
+      return a.priority_ != b.priority_ ? a.priority_ > b.priority_
+                                        : a.seq_ > b.seq_;
+    }
+
+    int64_t priority_;
+    std::size_t seq_;
+    void const* origin_;
+    offset_t pos_;
+    fn_t fn_;
+  };
+
+  void defer(void const* origin, offset_t const pos,
+             typename deferred::fn_t const fn) {
+    deferred_fifo_.push(deferred{0, deferred_seq_++, origin, pos, fn});
+  }
+
+  void defer(int64_t const priority, void const* origin, offset_t const pos,
+             typename deferred::fn_t const fn) {
+    deferred_heap_.push(deferred{priority, deferred_seq_++, origin, pos, fn});
+  }
+
+  void write_deferred() {
+    if constexpr (DEFER) {
+      while (!deferred_fifo_.empty() || !deferred_heap_.empty()) {
+        auto const from_fifo =
+            deferred_heap_.empty() ||
+            (!deferred_fifo_.empty() &&
+             deferred_heap_.top() < deferred_fifo_.front());
+        auto const next =
+            from_fifo ? deferred_fifo_.front() : deferred_heap_.top();
+        if (from_fifo) {
+          deferred_fifo_.pop();
+        } else {
+          deferred_heap_.pop();
+        }
+        next.fn_(*this, next.origin_, next.pos_);
+      }
+    }
+  }
+
+  // Registers a raw pointer slot for the relocation table.
+  void add_relocation(offset_t const pos) {
+    if constexpr (RELOCATIONS) {
+      relocations_.emplace_back(pos);
+    } else {
+      (void)pos;
+    }
+  }
 
-  std::map<void const*, offset_t> offsets_;
+  pointer_map<offset_t> offsets_;
   std::vector<pending_offset> pending_;
+  // Only constructed if the mode uses them (std::deque allocates).
+  std::conditional_t<RELOCATIONS, std::vector<offset_t>, unused_member>
+      relocations_;
+  std::conditional_t<DEDUPLICATE, raw::hash_map<std::string_view, offset_t>,
+                     unused_member>
+      blocks_;
+  std::conditional_t<DEFER, std::queue<deferred>, unused_member>
+      deferred_fifo_;
+  std::conditional_t<DEFER, std::priority_queue<deferred>, unused_member>
+      deferred_heap_;
+  std::size_t deferred_seq_{0U};
+  serialization_stats stats_;
   Target& t_;
 };
 
+// Return type of the generic serialize() function below.
+// Custom serialize() overloads are detected by their (different) return type.
+struct generic_serialize_t {};
+
 template <typename Ctx, typename T>
-void serialize(Ctx& c, T const* origin, offset_t const pos) {
+constexpr bool is_trivially_serializable();
+
+template <typename Ctx, typename Tuple, std::size_t... I>
+constexpr bool all_trivially_serializable(std::index_sequence<I...>) {
+  return (is_trivially_serializable<Ctx, std::tuple_element_t<I, Tuple>>() &&
+          ...);
+}
+
+// True if the bytes copied by c.write(ptr, size) are already the final
+// serialized representation of T: no pointers, no containers, no custom
+// serialize() function and no endian conversion. No per-element visit
+// is required for such types.
+template <typename Ctx, typename T>
+constexpr bool is_trivially_serializable() {
+  using Type = decay_t<T>;
+  if constexpr (std::is_array_v<Type>) {
+    return is_trivially_serializable<Ctx, std::remove_extent_t<Type>>();
+  } else if constexpr (is_array_v<Type>) {
+    return is_trivially_serializable<Ctx, typename Type::value_type>();
+  } else if constexpr (!std::is_same_v<decltype(serialize(
+                                           std::declval<Ctx&>(),
+                                           std::declval<Type const*>(),
+                                           std::declval<offset_t>())),
+                                       generic_serialize_t>) {
+    return false;
+  } else if constexpr (std::is_union_v<Type>) {
+    return true;
+  } else if constexpr (is_pointer_v<Type>) {
+    return false;
+  } else if constexpr (!std::is_scalar_v<Type>) {
+    if constexpr (std::is_aggregate_v<Type> &&
+                  std::is_standard_layout_v<Type> &&
+                  !std::is_polymorphic_v<Type>) {
+      using fields_t = decltype(to_tuple(std::declval<Type&>()));
+      return all_trivially_serializable<Ctx, fields_t>(
+          std::make_index_sequence<std::tuple_size_v<fields_t>>());
+    } else {
+      return false;
+    }
+  } else if constexpr (std::numeric_limits<Type>::is_integer ||
+                       std::is_floating_point_v<Type>) {
+    return !endian_conversion_necessary<Ctx::MODE>();
+  } else {
+    return true;
+  }
+}
+
+template <mode Mode>
+struct deserialization_context;
+
+template <typename Ctx, typename T>
+constexpr bool is_trivially_deserializable();
+
+// DEDUPLICATE_BLOCKS applies to vector / unique_ptr payloads whose
+// source bytes are the serialized bytes (no pointers to rewrite) and
+// that are not modified by deserialization: a custom deserialize()
+// would run once per reference on the same (shared) bytes.
+template <typename Ctx, typename T>
+constexpr bool is_deduplicated_block() {
+  return (Ctx::MODE & mode::DEDUPLICATE_BLOCKS) == mode::DEDUPLICATE_BLOCKS &&
+         is_trivially_serializable<Ctx, T>() &&
+         is_trivially_deserializable<deserialization_context<Ctx::MODE>, T>();
+}
+
+// mode::PAGE_ALIGN_LARGE_VECTORS: vector payloads of at least
+// LARGE_VECTOR_SIZE bytes start at a multiple of PAGE_ALIGNMENT (relative
+// to the start of the output, i.e. page aligned when memory mapped) and
+// are zero padded up to the next multiple. No other data shares their
+// pages, so each of them can be advised / prefetched / dropped on its own.
+// PAGE_ALIGNMENT is part of the format: 64 KiB covers 4K, 16K and 64K pages.
+constexpr auto const PAGE_ALIGNMENT = std::size_t{64U * 1024U};
+constexpr auto const LARGE_VECTOR_SIZE = std::size_t{64U * 1024U};
+
+template <typename Ctx>
+constexpr bool is_page_aligned_vector(std::size_t const size) {
+  return (Ctx::MODE & mode::PAGE_ALIGN_LARGE_VECTORS) ==
+             mode::PAGE_ALIGN_LARGE_VECTORS &&
+         size >= LARGE_VECTOR_SIZE;
+}
+
+template <typename Ctx, typename T>
+std::size_t vector_alignment(std::size_t const size) {
+  return is_page_aligned_vector<Ctx>(size)
+             ? std::max(PAGE_ALIGNMENT, std::alignment_of_v<T>)
+             : std::alignment_of_v<T>;
+}
+
+// Writes zeros from end up to the next multiple of alignment.
+template <typename Ctx>
+void write_tail_padding(Ctx& c, offset_t const end,
+                        std::size_t const alignment) {
+  static constexpr uint8_t const zeros[4096U] = {};
+  auto const a = static_cast<offset_t>(alignment);
+  auto n = static_cast<std::size_t>((a - end % a) % a);
+  while (n != 0U) {
+    auto const chunk_size = std::min(n, sizeof(zeros));
+    c.write(zeros, chunk_size);
+    n -= chunk_size;
+  }
+}
+
+// Size of arithmetic types that serialization plans byte swap directly
+// instead of calling serialize() / deserialize(), 0 otherwise.
+template <typename T>
+constexpr std::size_t plan_swap_size() {
+  if constexpr (std::numeric_limits<T>::is_integer ||
+                std::is_floating_point_v<T>) {
+    return sizeof(T);
+  } else {
+    return 0U;
+  }
+}
+
+template <typename Int>
+Int load_swapped(void const* src) {
+  auto i = Int{};
+  std::memcpy(&i, src, sizeof(i));
+  return endian_swap(i);
+}
+
+template <typename Int>
+void swap_in_place(uint8_t* first, uint32_t const count) {
+  for (auto i = 0U; i != count; ++i) {
+    auto const swapped = load_swapped<Int>(first + i * sizeof(Int));
+    std::memcpy(first + i * sizeof(Int), &swapped, sizeof(Int));
+  }
+}
+
+inline void swap_in_place(uint8_t* first, uint32_t const swap_size,
+                          uint32_t const count) {
+  switch (swap_size) {
+    case 2U: swap_in_place<uint16_t>(first, count); break;
+    case 4U: swap_in_place<uint32_t>(first, count); break;
+    default: swap_in_place<uint64_t>(first, count);
+  }
+}
+
+template <typename Int, typename Ctx>
+void write_swapped(Ctx& c, uint8_t const* first, offset_t const pos,
+                   uint32_t const count) {
+  for (auto i = 0U; i != count; ++i) {
+    auto const offset = static_cast<offset_t>(i * sizeof(Int));
+    c.write(pos + offset, load_swapped<Int>(first + offset));
+  }
+}
+
+// Writes a run of scalars byte swapped (same result as swap_in_place() on
+// a copy). The scalars of a run can have different types (e.g. int32_t and
+// float), so they are swapped as unsigned integers of swap_size bytes.
+template <typename Ctx>
+void write_swapped(Ctx& c, uint8_t const* first, offset_t const pos,
+                   uint32_t const swap_size, uint32_t const count) {
+  switch (swap_size) {
+    case 2U: write_swapped<uint16_t>(c, first, pos, count); break;
+    case 4U: write_swapped<uint32_t>(c, first, pos, count); break;
+    default: write_swapped<uint64_t>(c, first, pos, count);
+  }
+}
+
+// Flat list of the (nested) fields of an aggregate that require work
+// after its bytes have been copied. A slot is either a run of count_
+// adjacent scalars of swap_size_ bytes to byte swap or a single field
+// handled by fn_ (pointer, container, custom (de)serialize() function).
+// Runs can merge scalars of different types with the same size, so fn_ is
+// only set for single fields (swap_size_ == 0).
+template <typename Fn, std::size_t MaxSlots>
+struct field_plan {
+  struct slot {
+    offset_t offset_;
+    uint32_t swap_size_;  // 0: call fn_
+    uint32_t count_;
+    Fn fn_;
+  };
+
+  void add(offset_t const offset, std::size_t const swap_size, Fn fn) {
+    if (swap_size != 0U && size_ != 0U) {
+      auto& prev = slots_[size_ - 1U];
+      if (prev.swap_size_ == swap_size &&
+          prev.offset_ + prev.swap_size_ * prev.count_ == offset) {
+        ++prev.count_;
+        return;
+      }
+    }
+    slots_[size_++] = {offset, static_cast<uint32_t>(swap_size), 1U,
+                       swap_size == 0U ? fn : nullptr};
+  }
+
+  slot const* begin() const { return slots_.data(); }
+  slot const* end() const { return slots_.data() + size_; }
+
+  std::array<slot, MaxSlots> slots_{};
+  std::size_t size_{0U};
+};
+
+// Maximum aggregate size that is byte swapped in a stack buffer.
+constexpr auto const MAX_SWAP_BUFFER_SIZE = std::size_t{512U};
+
+// Aggregates without custom serialize() function. Nested ones are
+// flattened into the serialize_plan of the enclosing aggregate.
+template <typename Ctx, typename T>
+constexpr bool is_generic_serialized_aggregate() {
+  using Type = decay_t<T>;
+  if constexpr (std::is_union_v<Type> || std::is_array_v<Type> ||
+                is_pointer_v<Type> || std::is_scalar_v<Type>) {
+    return false;
+  } else {
+    return std::is_same_v<decltype(serialize(std::declval<Ctx&>(),
+                                             std::declval<Type const*>(),
+                                             std::declval<offset_t>())),
+                          generic_serialize_t> &&
+           std::is_aggregate_v<Type> && std::is_standard_layout_v<Type> &&
+           !std::is_polymorphic_v<Type>;
+  }
+}
+
+template <typename Ctx, typename T>
+constexpr std::size_t serialize_slot_count();
+
+template <typename Ctx, typename Tuple, std::size_t... I>
+constexpr std::size_t fields_serialize_slot_count(std::index_sequence<I...>) {
+  return (std::size_t{0U} + ... +
+          serialize_slot_count<
+              Ctx, std::remove_reference_t<std::tuple_element_t<I, Tuple>>>());
+}
+
+// Upper bound of the number of slots of T (before merging swap runs).
+template <typename Ctx, typename T>
+constexpr std::size_t serialize_slot_count() {
+  if constexpr (is_trivially_serializable<Ctx, T>() ||
+                plan_swap_size<decay_t<T>>() == 1U) {
+    return 0U;
+  } else if constexpr (is_generic_serialized_aggregate<Ctx, T>()) {
+    using fields_t = decltype(to_tuple(std::declval<decay_t<T>&>()));
+    return fields_serialize_slot_count<Ctx, fields_t>(
+        std::make_index_sequence<std::tuple_size_v<fields_t>>());
+  } else {
+    return 1U;
+  }
+}
+
+template <typename Ctx>
+using serialize_fn_t = void (*)(Ctx&, void const*, offset_t);
+
+template <typename Ctx, typename T>
+void serialize_slot_fn(Ctx& c, void const* origin, offset_t const pos) {
+  serialize(c, static_cast<T const*>(origin), pos);
+}
+
+template <typename Ctx, typename T, typename Plan>
+void add_serialize_slots(T const& el, intptr_t const base, Plan& plan) {
+  for_each_ptr_field(el, [&](auto& member) {
+    using Field = decay_t<std::remove_pointer_t<decay_t<decltype(member)>>>;
+    if constexpr (is_trivially_serializable<Ctx, Field>() ||
+                  plan_swap_size<Field>() == 1U) {
+      (void)plan;
+    } else if constexpr (is_generic_serialized_aggregate<Ctx, Field>()) {
+      add_serialize_slots<Ctx>(*member, base, plan);
+    } else {
+      plan.add(
+          static_cast<offset_t>(reinterpret_cast<intptr_t>(member) - base),
+          plan_swap_size<Field>(), &serialize_slot_fn<Ctx, Field>);
+    }
+  });
+}
+
+// The number of slots and their functions are known at compile time. The
+// offsets are taken once from the first object (they are the same for
+// all objects of type T).
+template <typename Ctx, typename T>
+auto const& serialize_plan(T const& el) {
+  static auto const plan = [&]() {
+    auto p = field_plan<serialize_fn_t<Ctx>, serialize_slot_count<Ctx, T>()>{};
+    add_serialize_slots<Ctx>(el, reinterpret_cast<intptr_t>(&el), p);
+    return p;
+  }();
+  return plan;
+}
+
+template <typename Ctx, typename T>
+generic_serialize_t serialize(Ctx& c, T const* origin, offset_t const pos) {
   using Type = decay_t<T>;
   if constexpr (std::is_union_v<Type>) {
     static_assert(std::is_standard_layout_v<Type> &&
                   std::is_trivially_copyable_v<Type>);
   } else if constexpr (is_pointer_v<Type>) {
+    if constexpr (std::is_pointer_v<Type>) {
+      c.add_relocation(pos);
+    }
     if (*origin == nullptr) {
       c.write(pos, convert_endian<Ctx::MODE>(NULLPTR_OFFSET));
-    } else if (auto const it = c.offsets_.find(*origin);
-               it != end(c.offsets_)) {
-      c.write(pos, convert_endian<Ctx::MODE>(it->second - pos));
+    } else if (auto const target = c.offsets_.find(*origin);
+               target != nullptr) {
+      c.write(pos, convert_endian<Ctx::MODE>(*target - pos));
     } else {
       c.pending_.emplace_back(pending_offset{*origin, pos});
     }
@@ -74,12 +552,37 @@ void serialize(Ctx& c, T const* origin, offset_t const pos) {
                       std::is_standard_layout_v<Type> &&
                       !std::is_polymorphic_v<Type>,
                   "Please implement custom serializer.");
-    for_each_ptr_field(*origin, [&](auto& member) {
-      auto const member_offset =
-          static_cast<offset_t>(reinterpret_cast<intptr_t>(member) -
-                                reinterpret_cast<intptr_t>(origin));
-      serialize(c, member, pos + member_offset);
-    });
+    if constexpr (!is_trivially_serializable<Ctx, Type>()) {
+      auto const base = reinterpret_cast<uint8_t const*>(origin);
+      auto const& plan = serialize_plan<Ctx>(*origin);
+      if constexpr (endian_conversion_necessary<Ctx::MODE>() &&
+                    sizeof(Type) <= MAX_SWAP_BUFFER_SIZE) {
+        // Byte swaps in a copy: one write instead of one per scalar.
+        uint8_t swapped[sizeof(Type)];
+        std::memcpy(swapped, base, sizeof(Type));
+        for (auto const& slot : plan) {
+          if (slot.swap_size_ != 0U) {
+            swap_in_place(swapped + slot.offset_, slot.swap_size_,
+                          slot.count_);
+          }
+        }
+        c.write(pos, swapped);
+        for (auto const& slot : plan) {
+          if (slot.swap_size_ == 0U) {
+            slot.fn_(c, base + slot.offset_, pos + slot.offset_);
+          }
+        }
+      } else {
+        for (auto const& slot : plan) {
+          if (slot.swap_size_ == 0U) {
+            slot.fn_(c, base + slot.offset_, pos + slot.offset_);
+          } else {
+            write_swapped(c, base + slot.offset_, pos + slot.offset_,
+                          slot.swap_size_, slot.count_);
+          }
+        }
+      }
+    }
   } else if constexpr (std::numeric_limits<Type>::is_integer ||
                        std::is_floating_point_v<Type>) {
     c.write(pos, convert_endian<Ctx::MODE>(*origin));
@@ -87,88 +590,215 @@ void serialize(Ctx& c, T const* origin, offset_t const pos) {
     (void)origin;
     (void)pos;
   }
+  return {};
 }
 
 template <typename Ctx, typename T, typename Ptr, typename TemplateSizeType>
 void serialize(Ctx& c, basic_vector<T, Ptr, TemplateSizeType> const* origin,
                offset_t const pos) {
+  using Type = basic_vector<T, Ptr, TemplateSizeType>;
+
   auto const size = serialized_size<T>() * origin->used_size_;
-  auto const start = origin->el_ == nullptr
-                         ? NULLPTR_OFFSET
-                         : c.write(static_cast<T const*>(origin->el_), size,
-                                   std::alignment_of_v<T>);
+  auto start = NULLPTR_OFFSET;
+  if (origin->el_ != nullptr) {
+    auto const alignment = vector_alignment<Ctx, T>(size);
+    auto written = true;
+    if constexpr (is_deduplicated_block<Ctx, T>()) {
+      auto const [offset, deduplicated] = c.write_deduplicated(
+          static_cast<T const*>(origin->el_), size, alignment);
+      c.stats_.deduplicated_blocks_ += deduplicated ? 1U : 0U;
+      start = offset;
+      written = !deduplicated;
+    } else {
+      start = c.write(static_cast<T const*>(origin->el_), size, alignment);
+    }
+    if (is_page_aligned_vector<Ctx>(size) && written) {
+      write_tail_padding(c, start + static_cast<offset_t>(size), alignment);
+    }
+  }
 
-  c.write(pos + cista_member_offset(offset::vector<T>, el_),
+  if constexpr (std::is_pointer_v<Ptr>) {
+    c.add_relocation(pos + cista_member_offset(Type, el_));
+  }
+  c.write(pos + cista_member_offset(Type, el_),
           convert_endian<Ctx::MODE>(
               start == NULLPTR_OFFSET
                   ? start
-                  : start - cista_member_offset(offset::vector<T>, el_) - pos));
-  c.write(pos + cista_member_offset(offset::vector<T>, allocated_size_),
+                  : start - cista_member_offset(Type, el_) - pos));
+  c.write(pos + cista_member_offset(Type, allocated_size_),
           convert_endian<Ctx::MODE>(origin->used_size_));
-  c.write(pos + cista_member_offset(offset::vector<T>, used_size_),
+  c.write(pos + cista_member_offset(Type, used_size_),
           convert_endian<Ctx::MODE>(origin->used_size_));
-  c.write(pos + cista_member_offset(offset::vector<T>, self_allocated_), false);
+  c.write(pos + cista_member_offset(Type, self_allocated_), false);
 
-  if (origin->el_ != nullptr) {
-    auto i = 0u;
-    for (auto it = start; it != start + static_cast<offset_t>(size);
-         it += serialized_size<T>()) {
-      serialize(c, static_cast<T const*>(origin->el_ + i++), it);
+  if constexpr (!is_trivially_serializable<Ctx, T>()) {
+    if constexpr (is_unique_ptr_v<T>) {
+      // Each element registers its target: size the pointer map up front.
+      c.offsets_.reserve(c.offsets_.size() + origin->used_size_);
+    }
+    if (origin->el_ != nullptr) {
+      auto i = std::size_t{0U};
+      for (auto it = start; it != start + static_cast<offset_t>(size);
+           it += serialized_size<T>()) {
+        serialize(c, static_cast<T const*>(origin->el_ + i++), it);
+      }
+    }
+  }
+}
+
+template <typename Ctx, typename T, template <typename> typename Ptr,
+          typename GetKey, typename GetValue, typename Hash, typename Eq>
+void serialize(Ctx& c,
+               hash_storage<T, Ptr, GetKey, GetValue, Hash, Eq> const* origin,
+               offset_t const pos) {
+  using Type = hash_storage<T, Ptr, GetKey, GetValue, Hash, Eq>;
+
+  // Entries and control bytes are written as one block (like allocated).
+  auto const entries_size = serialized_size<T>() * origin->capacity_;
+  auto const start =
+      origin->capacity_ == 0U
+          ? NULLPTR_OFFSET
+          : c.write(origin->entries(), Type::memory_size(origin->capacity_),
+                    std::alignment_of_v<T>);
+  auto const ctrl_start =
+      start == NULLPTR_OFFSET
+          ? start
+          : start + static_cast<offset_t>(entries_size);
+
+  if constexpr (std::is_pointer_v<Ptr<T>>) {
+    c.add_relocation(pos + cista_member_offset(Type, entries_));
+    c.add_relocation(pos + cista_member_offset(Type, ctrl_));
+  }
+  c.write(pos + cista_member_offset(Type, entries_),
+          convert_endian<Ctx::MODE>(
+              start == NULLPTR_OFFSET
+                  ? start
+                  : start - cista_member_offset(Type, entries_) - pos));
+  c.write(pos + cista_member_offset(Type, ctrl_),
+          convert_endian<Ctx::MODE>(
+              ctrl_start == NULLPTR_OFFSET
+                  ? ctrl_start
+                  : ctrl_start - cista_member_offset(Type, ctrl_) - pos));
+  c.write(pos + cista_member_offset(Type, size_),
+          convert_endian<Ctx::MODE>(origin->size_));
+  c.write(pos + cista_member_offset(Type, capacity_),
+          convert_endian<Ctx::MODE>(origin->capacity_));
+  c.write(pos + cista_member_offset(Type, growth_left_),
+          convert_endian<Ctx::MODE>(origin->growth_left_));
+  c.write(pos + cista_member_offset(Type, self_allocated_), false);
+
+  if constexpr (!is_trivially_serializable<Ctx, T>()) {
+    auto const ctrl = static_cast<int8_t const*>(origin->ctrl_);
+    for (auto i = offset_t{0}; i != origin->capacity_; ++i) {
+      if (hash_storage_detail::is_full(ctrl[i])) {
+        serialize(c, origin->entries() + i,
+                  start + i * static_cast<offset_t>(serialized_size<T>()));
+      }
     }
   }
 }
 
-template <typename Ctx, typename Ptr>
-void serialize(Ctx& c, basic_string<Ptr> const* origin, offset_t const pos) {
+template <typename Ctx, typename Ptr, typename SizeType>
+void serialize(Ctx& c, basic_string<Ptr, SizeType> const* origin,
+               offset_t const pos) {
+  using Type = basic_string<Ptr, SizeType>;
+
   if (origin->is_short()) {
     return;
   }
 
-  auto const start = (origin->h_.ptr_ == nullptr)
-                         ? NULLPTR_OFFSET
-                         : c.write(origin->data(), origin->size());
+  auto start = NULLPTR_OFFSET;
+  if (origin->h_.ptr_ != nullptr) {
+    if constexpr ((Ctx::MODE & mode::DEDUPLICATE_STRINGS) ==
+                  mode::DEDUPLICATE_STRINGS) {
+      auto const [offset, deduplicated] =
+          c.write_deduplicated(origin->data(), origin->size());
+      c.stats_.deduplicated_strings_ += deduplicated ? 1U : 0U;
+      start = offset;
+    } else {
+      start = c.write(origin->data(), origin->size());
+    }
+  }
+  if constexpr (std::is_pointer_v<Ptr>) {
+    c.add_relocation(pos + cista_member_offset(Type, h_.ptr_));
+  }
   c.write(
-      pos + cista_member_offset(offset::string, h_.ptr_),
+      pos + cista_member_offset(Type, h_.ptr_),
       convert_endian<Ctx::MODE>(
           start == NULLPTR_OFFSET
               ? start
-              : start - cista_member_offset(offset::string, h_.ptr_) - pos));
-  c.write(pos + cista_member_offset(offset::string, h_.size_),
+              : start - cista_member_offset(Type, h_.ptr_) - pos));
+  c.write(pos + cista_member_offset(Type, h_.size_),
           convert_endian<Ctx::MODE>(origin->h_.size_));
-  c.write(pos + cista_member_offset(offset::string, h_.self_allocated_), false);
+  c.write(pos + cista_member_offset(Type, h_.self_allocated_), false);
+}
+
+// Writes the target of the unique_ptr at pos and sets its pointer.
+template <typename Ctx, typename T>
+void serialize_unique_ptr_target(Ctx& c, void const* origin,
+                                 offset_t const pos) {
+  auto const ptr = static_cast<T const*>(origin);
+  auto start = NULLPTR_OFFSET;
+  if constexpr (is_deduplicated_block<Ctx, T>()) {
+    auto const [offset, deduplicated] = c.write_deduplicated(
+        ptr, serialized_size<T>(), std::alignment_of_v<T>);
+    c.stats_.deduplicated_blocks_ += deduplicated ? 1U : 0U;
+    start = offset;
+  } else {
+    start = c.write(ptr, serialized_size<T>(), std::alignment_of_v<T>);
+  }
+
+  c.write(pos + cista_member_offset(offset::unique_ptr<T>, el_),
+          convert_endian<Ctx::MODE>(
+              start - cista_member_offset(offset::unique_ptr<T>, el_) - pos));
+
+  c.offsets_[ptr] = start;
+  if constexpr (!is_trivially_serializable<Ctx, T>()) {
+    serialize(c, ptr, start);
+  }
 }
 
 template <typename Ctx, typename T, typename Ptr>
 void serialize(Ctx& c, basic_unique_ptr<T, Ptr> const* origin,
                offset_t const pos) {
-  auto const start =
-      origin->el_ == nullptr
-          ? NULLPTR_OFFSET
-          : c.write(origin->el_, serialized_size<T>(), std::alignment_of_v<T>);
-
-  c.write(
-      pos + cista_member_offset(offset::unique_ptr<T>, el_),
-      convert_endian<Ctx::MODE>(
-          start == NULLPTR_OFFSET
-              ? start
-              : start - cista_member_offset(offset::unique_ptr<T>, el_) - pos));
+  if constexpr (std::is_pointer_v<Ptr>) {
+    c.add_relocation(pos + cista_member_offset(offset::unique_ptr<T>, el_));
+  }
   c.write(pos + cista_member_offset(offset::unique_ptr<T>, self_allocated_),
           false);
 
-  if (origin->el_ != nullptr) {
-    auto const ptr = static_cast<T const*>(origin->el_);
-    c.offsets_[ptr] = start;
-    serialize(c, ptr, start);
+  if (origin->el_ == nullptr) {
+    c.write(pos + cista_member_offset(offset::unique_ptr<T>, el_),
+            convert_endian<Ctx::MODE>(NULLPTR_OFFSET));
+  } else if constexpr ((Ctx::MODE & mode::BREADTH_FIRST_LAYOUT) ==
+                       mode::BREADTH_FIRST_LAYOUT) {
+    if constexpr (has_layout_priority<T>::value) {
+      c.defer(static_cast<int64_t>(
+                  layout_priority(*static_cast<T const*>(origin->el_))),
+              static_cast<T const*>(origin->el_), pos,
+              &serialize_unique_ptr_target<Ctx, T>);
+    } else {
+      c.defer(static_cast<T const*>(origin->el_), pos,
+              &serialize_unique_ptr_target<Ctx, T>);
+    }
+  } else {
+    serialize_unique_ptr_target<Ctx, T>(c, origin->el_, pos);
   }
 }
 
 template <typename Ctx, typename T, size_t Size>
 void serialize(Ctx& c, array<T, Size> const* origin, offset_t const pos) {
-  auto const size =
-      static_cast<offset_t>(serialized_size<T>() * origin->size());
-  auto i = 0u;
-  for (auto it = pos; it != pos + size; it += serialized_size<T>()) {
-    serialize(c, origin->el_ + i++, it);
+  if constexpr (!is_trivially_serializable<Ctx, T>()) {
+    auto const size =
+        static_cast<offset_t>(serialized_size<T>() * origin->size());
+    auto i = 0u;
+    for (auto it = pos; it != pos + size; it += serialized_size<T>()) {
+      serialize(c, origin->el_ + i++, it);
+    }
+  } else {
+    (void)c;
+    (void)origin;
+    (void)pos;
   }
 }
 
@@ -180,7 +810,7 @@ constexpr offset_t integrity_start(mode const m) {
   return start;
 }
 
-constexpr offset_t data_start(mode const m) {
+constexpr offset_t relocations_start(mode const m) {
   auto start = integrity_start(m);
   if ((m & mode::WITH_INTEGRITY) == mode::WITH_INTEGRITY) {
     start += sizeof(uint64_t);
@@ -188,10 +818,33 @@ constexpr offset_t data_start(mode const m) {
   return start;
 }
 
+constexpr offset_t block_table_start(mode const m) {
+  auto start = relocations_start(m);
+  if ((m & mode::WITH_RELOCATIONS) == mode::WITH_RELOCATIONS) {
+    start += sizeof(offset_t);
+  }
+  return start;
+}
+
+constexpr offset_t data_start(mode const m) {
+  auto start = block_table_start(m);
+  if ((m & mode::BLOCK_CHECKSUMS) == mode::BLOCK_CHECKSUMS) {
+    start += sizeof(offset_t);
+  }
+  return start;
+}
+
 template <mode const Mode = mode::NONE, typename Target, typename T>
-void serialize(Target& t, T& value) {
+serialization_stats serialize(Target& t, T& value) {
   serialization_context<Target, Mode> c{t};
 
+  if constexpr ((Mode & mode::WITH_INTEGRITY) == mode::WITH_INTEGRITY &&
+                (Mode & mode::INCREMENTAL_CHECKSUM) ==
+                    mode::INCREMENTAL_CHECKSUM &&
+                has_incremental_checksum<Target>::value) {
+    t.track_checksum();
+  }
+
   if constexpr ((Mode & mode::WITH_VERSION) == mode::WITH_VERSION) {
     auto const h = convert_endian<Mode>(type_hash<decay_t<T>>());
     c.write(&h, sizeof(h));
@@ -203,24 +856,84 @@ void serialize(Target& t, T& value) {
     integrity_offset = c.write(&h, sizeof(h));
   }
 
+  auto relocations_offset = offset_t{0};
+  if constexpr ((Mode & mode::WITH_RELOCATIONS) == mode::WITH_RELOCATIONS) {
+    auto const table_start = offset_t{0};
+    relocations_offset = c.write(&table_start, sizeof(table_start));
+  }
+
+  auto block_table_offset = offset_t{0};
+  if constexpr ((Mode & mode::BLOCK_CHECKSUMS) == mode::BLOCK_CHECKSUMS) {
+    auto const table_start = offset_t{0};
+    block_table_offset = c.write(&table_start, sizeof(table_start));
+  }
+
   serialize(c, &value,
             c.write(&value, serialized_size<T>(),
                     std::alignment_of_v<decay_t<decltype(value)>>));
+  c.write_deferred();
 
   for (auto& p : c.pending_) {
-    if (auto const it = c.offsets_.find(p.origin_ptr_); it != end(c.offsets_)) {
-      c.write(p.pos_, convert_endian<Mode>(it->second - p.pos_));
+    if (auto const target = c.offsets_.find(p.origin_ptr_);
+        target != nullptr) {
+      c.write(p.pos_, convert_endian<Mode>(*target - p.pos_));
     } else {
       printf("warning: dangling pointer %p serialized at offset %" PRI_O "\n",
              p.origin_ptr_, p.pos_);
     }
   }
 
+  if constexpr ((Mode & mode::WITH_RELOCATIONS) == mode::WITH_RELOCATIONS) {
+    auto& r = c.relocations_;
+    std::sort(begin(r), end(r));
+    r.erase(std::unique(begin(r), end(r)), end(r));
+    auto const count = convert_endian<Mode>(static_cast<uint64_t>(r.size()));
+    auto const table_start =
+        c.write(&count, sizeof(count), std::alignment_of_v<uint64_t>);
+    for (auto& pos : r) {
+      pos = convert_endian<Mode>(pos);
+    }
+    if (!r.empty()) {
+      c.write(r.data(), r.size() * sizeof(offset_t));
+    }
+    c.write(relocations_offset, convert_endian<Mode>(table_start));
+  }
+
+  // Block table: [block size][count][hash of each block of the data]
+  if constexpr ((Mode & mode::BLOCK_CHECKSUMS) == mode::BLOCK_CHECKSUMS) {
+    auto const block_size =
+        convert_endian<Mode>(static_cast<uint64_t>(BLOCK_CHECKSUM_SIZE));
+    auto const table_start = c.write(&block_size, sizeof(block_size),
+                                     std::alignment_of_v<uint64_t>);
+    auto hashes = c.block_checksums(data_start(Mode), table_start);
+    for (auto& h : hashes) {
+      h = convert_endian<Mode>(h);
+    }
+    auto const count =
+        convert_endian<Mode>(static_cast<uint64_t>(hashes.size()));
+    c.write(&count, sizeof(count));
+    if (!hashes.empty()) {
+      c.write(hashes.data(), hashes.size() * sizeof(hash_t));
+    }
+    c.write(block_table_offset, convert_endian<Mode>(table_start));
+  }
+
   if constexpr ((Mode & mode::WITH_INTEGRITY) == mode::WITH_INTEGRITY) {
     auto const csum =
         c.checksum(integrity_offset + static_cast<offset_t>(sizeof(hash_t)));
     c.write(integrity_offset, convert_endian<Mode>(csum));
   }
+
+  return c.stats_;
+}
+
+// Exact number of bytes serialize<Mode>() writes for value (incl. padding).
+// Can be used to reserve the output buffer / file up front.
+template <mode const Mode = mode::NONE, typename T>
+std::size_t serialized_size_of(T const& value) {
+  auto counter = byte_counter{};
+  serialize<Mode>(counter, value);
+  return counter.size_;
 }
 
 template <mode const Mode = mode::NONE, typename T>
@@ -313,10 +1026,137 @@ struct deserialization_context {
   }
 
   intptr_t from_, to_;
+  unsigned parallelism_{1U};
+};
+
+// Minimum number of elements (vectors, arrays) or relocations
+// to distribute the deserialization work to worker threads.
+constexpr auto const MIN_PARALLEL_DESERIALIZE = std::size_t{1024U};
+
+template <mode const Mode>
+uint64_t integrity_checksum(std::string_view const s,
+                            unsigned const parallelism = 1U) {
+  if constexpr (std::is_same_v<integrity_hasher_t<Mode>, word_hasher>) {
+    return word_hash(s, parallelism);
+  } else if constexpr ((Mode & mode::CHUNKED_CHECKSUM) ==
+                       mode::CHUNKED_CHECKSUM) {
+    return chunked_checksum<integrity_base_hasher_t<Mode>>(s, parallelism);
+  } else if constexpr ((Mode & mode::WIDE_CHECKSUM) == mode::WIDE_CHECKSUM) {
+    (void)parallelism;
+    return wide_hash(s);
+  } else {
+    (void)parallelism;
+    return hash(s);
+  }
+}
+
+// Lazy verification of a buffer serialized with mode::BLOCK_CHECKSUMS.
+// Construction only reads the table location (no hashing). Each block is
+// hashed and compared the first time a range in it is requested through
+// verify_range() / verified() (thread safe, throws on mismatch).
+// The data has to be accessed in place, i.e. offset mode (raw mode
+// deserialize() modifies the buffer; it verifies all blocks up front).
+template <mode const Mode>
+struct block_verifier {
+  static_assert((Mode & mode::BLOCK_CHECKSUMS) == mode::BLOCK_CHECKSUMS);
+
+  block_verifier(uint8_t const* from, uint8_t const* to)
+      : data_{from + data_start(Mode)} {
+    verify(to - from >= data_start(Mode), "invalid range");
+    auto const read = [&](std::size_t const pos) {
+      verify(pos % sizeof(uint64_t) == 0U &&
+                 pos + sizeof(uint64_t) <= static_cast<std::size_t>(to - from),
+             "invalid block table");
+      return static_cast<std::size_t>(convert_endian<Mode>(
+          *reinterpret_cast<uint64_t const*>(from + pos)));
+    };
+
+    auto const table_start = read(block_table_start(Mode));
+    verify(table_start >= data_start(Mode), "invalid block table");
+    block_size_ = read(table_start);
+    n_blocks_ = read(table_start + sizeof(uint64_t));
+    data_size_ = table_start - data_start(Mode);
+    auto const size = static_cast<std::size_t>(to - from);
+    verify(block_size_ != 0U && n_blocks_ <= size / sizeof(hash_t) &&
+               n_blocks_ == data_size_ / block_size_ +
+                                (data_size_ % block_size_ != 0U ? 1U : 0U),
+           "invalid block table");
+    hashes_ = reinterpret_cast<hash_t const*>(from + table_start +
+                                              2U * sizeof(uint64_t));
+    verify(reinterpret_cast<uint8_t const*>(hashes_ + n_blocks_) <= to,
+           "invalid block table");
+    verified_ = std::make_unique<std::atomic<bool>[]>(n_blocks_);
+  }
+
+  // Root object of an offset mode buffer with its block(s) verified.
+  template <typename T>
+  T const* root() {
+    if constexpr ((Mode & mode::WITH_VERSION) == mode::WITH_VERSION) {
+      verify(convert_endian<Mode>(*reinterpret_cast<hash_t const*>(
+                 data_ - data_start(Mode))) == type_hash<T>(),
+             "invalid version");
+    }
+    return verified(reinterpret_cast<T const*>(data_));
+  }
+
+  template <typename T>
+  T const* verified(T const* el) {
+    verify_range(el, sizeof(T));
+    return el;
+  }
+
+  void verify_range(void const* ptr, std::size_t const size) {
+    if (size == 0U) {
+      return;
+    }
+    auto const pos = static_cast<uint8_t const*>(ptr) - data_;
+    verify(pos >= 0 && static_cast<std::size_t>(pos) <= data_size_ &&
+               size <= data_size_ - static_cast<std::size_t>(pos),
+           "verify_range out of bounds");
+    auto const first = static_cast<std::size_t>(pos) / block_size_;
+    auto const last = (static_cast<std::size_t>(pos) + size - 1U) / block_size_;
+    for (auto i = first; i <= last; ++i) {
+      verify_block(i);
+    }
+  }
+
+  void verify_all(unsigned const parallelism = 1U) {
+    parallel_for(parallelism, n_blocks_,
+                 [&](std::size_t const from, std::size_t const to) {
+                   for (auto i = from; i != to; ++i) {
+                     verify_block(i);
+                   }
+                 });
+  }
+
+  bool is_verified(std::size_t const block) const {
+    return verified_[block].load(std::memory_order_acquire);
+  }
+
+  std::size_t n_blocks() const { return n_blocks_; }
+
+private:
+  void verify_block(std::size_t const i) {
+    if (is_verified(i)) {
+      return;
+    }
+    auto const offset = i * block_size_;
+    auto const h = block_checksum<integrity_base_hasher_t<Mode>>(
+        std::string_view{reinterpret_cast<char const*>(data_ + offset),
+                         std::min(block_size_, data_size_ - offset)});
+    verify(h == convert_endian<Mode>(hashes_[i]), "invalid block checksum");
+    verified_[i].store(true, std::memory_order_release);
+  }
+
+  uint8_t const* data_;
+  hash_t const* hashes_{nullptr};
+  std::size_t data_size_{0U}, block_size_{0U}, n_blocks_{0U};
+  std::unique_ptr<std::atomic<bool>[]> verified_;
 };
 
 template <typename T, mode const Mode = mode::NONE>
-void check(uint8_t const* from, uint8_t const* to) {
+void check(uint8_t const* from, uint8_t const* to,
+           unsigned const parallelism = 1U) {
   verify(to - from > data_start(Mode), "invalid range");
 
   if constexpr ((Mode & mode::WITH_VERSION) == mode::WITH_VERSION) {
@@ -326,17 +1166,153 @@ void check(uint8_t const* from, uint8_t const* to) {
   }
 
   if constexpr ((Mode & mode::WITH_INTEGRITY) == mode::WITH_INTEGRITY) {
+    auto const checksum_start = from + relocations_start(Mode);
     verify(convert_endian<Mode>(*reinterpret_cast<uint64_t const*>(
                from + integrity_start(Mode))) ==
-               hash(std::string_view{
-                   reinterpret_cast<char const*>(from + data_start(Mode)),
-                   static_cast<size_t>(to - from - data_start(Mode))}),
+               integrity_checksum<Mode>(
+                   std::string_view{
+                       reinterpret_cast<char const*>(checksum_start),
+                       static_cast<size_t>(to - checksum_start)},
+                   parallelism),
            "invalid checksum");
   }
+
+  if constexpr ((Mode & mode::BLOCK_CHECKSUMS) == mode::BLOCK_CHECKSUMS) {
+    block_verifier<Mode>{from, to}.verify_all(parallelism);
+  }
+}
+
+// Return type of the generic deserialize() function below.
+// Custom deserialize() overloads are detected by their (different) return
+// type.
+struct generic_deserialize_t {};
+
+template <typename Ctx, typename T>
+constexpr bool is_trivially_deserializable();
+
+template <typename Ctx, typename Tuple, std::size_t... I>
+constexpr bool all_trivially_deserializable(std::index_sequence<I...>) {
+  return (is_trivially_deserializable<Ctx, std::tuple_element_t<I, Tuple>>() &&
+          ...);
+}
+
+// True if deserializing T does not require any per-element work:
+// no pointers to convert, no custom deserialize() function and no endian
+// conversion. A range check of the memory block holding T is sufficient.
+template <typename Ctx, typename T>
+constexpr bool is_trivially_deserializable() {
+  using Type = decay_t<T>;
+  if constexpr (std::is_array_v<Type>) {
+    return is_trivially_deserializable<Ctx, std::remove_extent_t<Type>>();
+  } else if constexpr (is_array_v<Type>) {
+    return is_trivially_deserializable<Ctx, typename Type::value_type>();
+  } else if constexpr (!std::is_same_v<decltype(deserialize(
+                                           std::declval<Ctx const&>(),
+                                           std::declval<Type*>())),
+                                       generic_deserialize_t>) {
+    return false;
+  } else if constexpr (std::is_union_v<Type>) {
+    return true;
+  } else if constexpr (is_pointer_v<Type>) {
+    return false;
+  } else if constexpr (!std::is_scalar_v<Type>) {
+    if constexpr (std::is_aggregate_v<Type> &&
+                  std::is_standard_layout_v<Type> &&
+                  !std::is_polymorphic_v<Type>) {
+      using fields_t = decltype(to_tuple(std::declval<Type&>()));
+      return all_trivially_deserializable<Ctx, fields_t>(
+          std::make_index_sequence<std::tuple_size_v<fields_t>>());
+    } else {
+      return false;
+    }
+  } else if constexpr (std::numeric_limits<Type>::is_integer ||
+                       std::is_floating_point_v<Type>) {
+    return !endian_conversion_necessary<Ctx::MODE>();
+  } else {
+    return true;
+  }
+}
+
+// Aggregates without custom deserialize() function. Nested ones are
+// flattened into the deserialize_plan of the enclosing aggregate.
+template <typename Ctx, typename T>
+constexpr bool is_generic_deserialized_aggregate() {
+  using Type = decay_t<T>;
+  if constexpr (std::is_union_v<Type> || std::is_array_v<Type> ||
+                is_pointer_v<Type> || std::is_scalar_v<Type>) {
+    return false;
+  } else {
+    return std::is_same_v<decltype(deserialize(std::declval<Ctx const&>(),
+                                               std::declval<Type*>())),
+                          generic_deserialize_t> &&
+           std::is_aggregate_v<Type> && std::is_standard_layout_v<Type> &&
+           !std::is_polymorphic_v<Type>;
+  }
+}
+
+template <typename Ctx, typename T>
+constexpr std::size_t deserialize_slot_count();
+
+template <typename Ctx, typename Tuple, std::size_t... I>
+constexpr std::size_t fields_deserialize_slot_count(
+    std::index_sequence<I...>) {
+  return (std::size_t{0U} + ... +
+          deserialize_slot_count<
+              Ctx, std::remove_reference_t<std::tuple_element_t<I, Tuple>>>());
+}
+
+template <typename Ctx, typename T>
+constexpr std::size_t deserialize_slot_count() {
+  if constexpr (is_trivially_deserializable<Ctx, T>() ||
+                plan_swap_size<decay_t<T>>() == 1U) {
+    return 0U;
+  } else if constexpr (is_generic_deserialized_aggregate<Ctx, T>()) {
+    using fields_t = decltype(to_tuple(std::declval<decay_t<T>&>()));
+    return fields_deserialize_slot_count<Ctx, fields_t>(
+        std::make_index_sequence<std::tuple_size_v<fields_t>>());
+  } else {
+    return 1U;
+  }
 }
 
+template <typename Ctx>
+using deserialize_fn_t = void (*)(Ctx const&, void*);
+
 template <typename Ctx, typename T>
-void deserialize(Ctx const& c, T* el) {
+void deserialize_slot_fn(Ctx const& c, void* el) {
+  deserialize(c, static_cast<T*>(el));
+}
+
+template <typename Ctx, typename T, typename Plan>
+void add_deserialize_slots(T& el, intptr_t const base, Plan& plan) {
+  for_each_ptr_field(el, [&](auto& member) {
+    using Field = decay_t<std::remove_pointer_t<decay_t<decltype(member)>>>;
+    if constexpr (is_trivially_deserializable<Ctx, Field>() ||
+                  plan_swap_size<Field>() == 1U) {
+      (void)plan;
+    } else if constexpr (is_generic_deserialized_aggregate<Ctx, Field>()) {
+      add_deserialize_slots<Ctx>(*member, base, plan);
+    } else {
+      plan.add(
+          static_cast<offset_t>(reinterpret_cast<intptr_t>(member) - base),
+          plan_swap_size<Field>(), &deserialize_slot_fn<Ctx, Field>);
+    }
+  });
+}
+
+template <typename Ctx, typename T>
+auto const& deserialize_plan(T& el) {
+  static auto const plan = [&]() {
+    auto p =
+        field_plan<deserialize_fn_t<Ctx>, deserialize_slot_count<Ctx, T>()>{};
+    add_deserialize_slots<Ctx>(el, reinterpret_cast<intptr_t>(&el), p);
+    return p;
+  }();
+  return plan;
+}
+
+template <typename Ctx, typename T>
+generic_deserialize_t deserialize(Ctx const& c, T* el) {
   using written_type_t = decay_t<T>;
   if constexpr (std::is_union_v<written_type_t>) {
     static_assert(std::is_standard_layout_v<written_type_t> &&
@@ -350,8 +1326,38 @@ void deserialize(Ctx const& c, T* el) {
         std::is_floating_point_v<written_type_t>) {
       c.convert_endian(*el);
     }
+  } else if constexpr (is_trivially_deserializable<Ctx, written_type_t>()) {
+    c.check(el, sizeof(T));
   } else {
-    for_each_ptr_field(*el, [&](auto& f) { deserialize(c, f); });
+    // Covers the trivially deserializable fields skipped by the plan.
+    c.check(el, sizeof(T));
+    auto const base = reinterpret_cast<uint8_t*>(el);
+    for (auto const& slot : deserialize_plan<Ctx>(*el)) {
+      if (slot.swap_size_ == 0U) {
+        slot.fn_(c, base + slot.offset_);
+      } else {
+        swap_in_place(base + slot.offset_, slot.swap_size_, slot.count_);
+      }
+    }
+  }
+  return {};
+}
+
+template <typename Ctx, typename T>
+void deserialize_elements(Ctx const& c, T* first, std::size_t const n) {
+  if (c.parallelism_ > 1U && n >= MIN_PARALLEL_DESERIALIZE) {
+    auto serial = c;
+    serial.parallelism_ = 1U;
+    parallel_for(c.parallelism_, n, [&](std::size_t const from,
+                                        std::size_t const to) {
+      for (auto i = from; i != to; ++i) {
+        deserialize(serial, first + i);
+      }
+    });
+  } else {
+    for (auto i = std::size_t{0U}; i != n; ++i) {
+      deserialize(c, first + i);
+    }
   }
 }
 
@@ -374,14 +1380,73 @@ void deserialize(Ctx const& c, basic_vector<T, Ptr, TemplateSizeType>* el) {
                                  sizeof(T)));
   c.check(el->allocated_size_ == el->used_size_, "vector size mismatch");
   c.check(!el->self_allocated_, "vector self-allocated");
-  for (auto& m : *el) {
-    deserialize(c, &m);
+  if constexpr (!is_trivially_deserializable<Ctx, T>()) {
+    deserialize_elements(c, el->begin(), el->size());
+  }
+}
+
+template <typename Ctx, typename T, template <typename> typename Ptr,
+          typename GetKey, typename GetValue, typename Hash, typename Eq>
+void deserialize(Ctx const& c,
+                 hash_storage<T, Ptr, GetKey, GetValue, Hash, Eq>* el) {
+  using namespace hash_storage_detail;
+  using Type = hash_storage<T, Ptr, GetKey, GetValue, Hash, Eq>;
+  c.check(el, sizeof(Type));
+  deserialize(c, &el->entries_);
+  deserialize(c, &el->ctrl_);
+  c.convert_endian(el->size_);
+  c.convert_endian(el->capacity_);
+  c.convert_endian(el->growth_left_);
+  c.check(!el->self_allocated_, "hash_storage self-allocated");
+
+  auto const capacity = static_cast<std::size_t>(el->capacity_);
+  if (capacity == 0U) {
+    c.check(el->entries_ == nullptr && el->ctrl_ == nullptr &&
+                el->size_ == 0U && el->growth_left_ == 0U,
+            "hash_storage empty table mismatch");
+    return;
+  }
+
+  auto const ctrl = static_cast<ctrl_t const*>(el->ctrl_);
+  c.check(capacity >= MIN_CAPACITY && (capacity & (capacity + 1U)) == 0U,
+          "hash_storage capacity");
+  c.check(el->entries(), checked_multiplication(capacity, sizeof(T)));
+  c.check(ctrl, capacity + 1U + CLONED_BYTES);
+  c.check(el->entries_ != nullptr && ctrl != nullptr,
+          "hash_storage nullptr");
+
+  // Lookups terminate at empty slots, inserts require non-full slots:
+  // corrupted control bytes must not lead to endless probing.
+  if constexpr ((Ctx::MODE & mode::UNCHECKED) != mode::UNCHECKED) {
+    auto full = std::size_t{0U}, empty = std::size_t{0U};
+    for (auto i = std::size_t{0U}; i != capacity; ++i) {
+      full += is_full(ctrl[i]) ? 1U : 0U;
+      empty += ctrl[i] == EMPTY ? 1U : 0U;
+      c.check(is_full(ctrl[i]) || ctrl[i] == EMPTY || ctrl[i] == DELETED,
+              "hash_storage invalid control byte");
+    }
+    c.check(ctrl[capacity] == END, "hash_storage missing end marker");
+    c.check(std::equal(ctrl, ctrl + CLONED_BYTES, ctrl + capacity + 1U),
+            "hash_storage cloned control bytes mismatch");
+    c.check(full == el->size_, "hash_storage size mismatch");
+    c.check(empty > el->growth_left_ &&
+                el->size_ + el->growth_left_ <=
+                    Type::capacity_to_growth(capacity),
+            "hash_storage growth mismatch");
+  }
+
+  if constexpr (!is_trivially_deserializable<Ctx, T>()) {
+    for (auto i = std::size_t{0U}; i != capacity; ++i) {
+      if (is_full(ctrl[i])) {
+        deserialize(c, el->entries() + i);
+      }
+    }
   }
 }
 
-template <typename Ctx, typename Ptr>
-void deserialize(Ctx const& c, basic_string<Ptr>* el) {
-  c.check(el, sizeof(basic_string<Ptr>));
+template <typename Ctx, typename Ptr, typename SizeType>
+void deserialize(Ctx const& c, basic_string<Ptr, SizeType>* el) {
+  c.check(el, sizeof(basic_string<Ptr, SizeType>));
   if (!el->is_short()) {
     deserialize(c, &el->h_.ptr_);
     c.convert_endian(el->h_.size_);
@@ -395,41 +1460,175 @@ void deserialize(Ctx const& c, basic_unique_ptr<T, Ptr>* el) {
   c.check(el, sizeof(basic_unique_ptr<T, Ptr>));
   c.check(!el->self_allocated_, "unique_ptr self-allocated");
   deserialize(c, &el->el_);
-  if (el->el_ != nullptr) {
-    deserialize(c, static_cast<T*>(el->el_));
+  if constexpr (!is_trivially_deserializable<Ctx, T>()) {
+    if (el->el_ != nullptr) {
+      deserialize(c, static_cast<T*>(el->el_));
+    }
   }
 }
 
 template <typename Ctx, typename T, size_t Size>
 void deserialize(Ctx const& c, array<T, Size>* el) {
   c.check(el, sizeof(array<T, Size>));
-  for (auto& m : *el) {
-    deserialize(c, &m);
+  if constexpr (!is_trivially_deserializable<Ctx, T>()) {
+    deserialize_elements(c, el->begin(), Size);
   }
 }
 
+// Element type deserialized by the container overloads above (void: none).
+template <typename T>
+struct deserialized_element {
+  static constexpr auto const container = false;
+  using type = void;
+};
+
+template <typename Ptr, typename SizeType>
+struct deserialized_element<basic_string<Ptr, SizeType>> {
+  static constexpr auto const container = true;
+  using type = void;
+};
+
+template <typename T, typename Ptr, typename TemplateSizeType>
+struct deserialized_element<basic_vector<T, Ptr, TemplateSizeType>> {
+  static constexpr auto const container = true;
+  using type = T;
+};
+
+template <typename T, template <typename> typename Ptr, typename GetKey,
+          typename GetValue, typename Hash, typename Eq>
+struct deserialized_element<
+    hash_storage<T, Ptr, GetKey, GetValue, Hash, Eq>> {
+  static constexpr auto const container = true;
+  using type = T;
+};
+
+template <typename T, typename Ptr>
+struct deserialized_element<basic_unique_ptr<T, Ptr>> {
+  static constexpr auto const container = true;
+  using type = T;
+};
+
+template <typename T>
+constexpr bool is_deserialize_container() {
+  return deserialized_element<T>::container || is_pointer_v<T>;
+}
+
+template <typename Ctx, typename T, typename... Visited>
+constexpr bool has_custom_deserialize();
+
+template <typename Ctx, typename Tuple, typename... Visited,
+          std::size_t... I>
+constexpr bool any_custom_deserialize(std::tuple<Visited...> const*,
+                                      std::index_sequence<I...>) {
+  return (has_custom_deserialize<Ctx, std::tuple_element_t<I, Tuple>,
+                                 Visited...>() ||
+          ...);
+}
+
+// True if deserializing T calls a user defined deserialize() function
+// (any overload except the generic one and the container overloads).
+// Visited terminates the recursion for recursive types.
+template <typename Ctx, typename T, typename... Visited>
+constexpr bool has_custom_deserialize() {
+  using Type = decay_t<T>;
+  if constexpr ((std::is_same_v<Type, Visited> || ...)) {
+    return false;
+  } else if constexpr (std::is_array_v<Type>) {
+    return has_custom_deserialize<Ctx, std::remove_extent_t<Type>,
+                                  Visited...>();
+  } else if constexpr (is_array_v<Type>) {
+    return has_custom_deserialize<Ctx, typename Type::value_type,
+                                  Visited...>();
+  } else if constexpr (is_deserialize_container<Type>()) {
+    using element_t = typename deserialized_element<Type>::type;
+    if constexpr (std::is_void_v<element_t>) {
+      return false;
+    } else {
+      return has_custom_deserialize<Ctx, element_t, Type, Visited...>();
+    }
+  } else if constexpr (!std::is_same_v<decltype(deserialize(
+                                           std::declval<Ctx const&>(),
+                                           std::declval<Type*>())),
+                                       generic_deserialize_t>) {
+    return true;
+  } else if constexpr (std::is_aggregate_v<Type> &&
+                       std::is_standard_layout_v<Type> &&
+                       !std::is_union_v<Type> &&
+                       !std::is_polymorphic_v<Type>) {
+    using fields_t = decltype(to_tuple(std::declval<Type&>()));
+    return any_custom_deserialize<Ctx, fields_t>(
+        static_cast<std::tuple<Type, Visited...> const*>(nullptr),
+        std::make_index_sequence<std::tuple_size_v<fields_t>>());
+  } else {
+    return false;
+  }
+}
+
+// Converts all raw pointers listed in the relocation table from offsets to
+// pointers without walking the object graph. The table holds no type
+// information (pointee sizes, container sizes and flags), so it is only
+// used for unchecked deserialization: checked deserialization always walks
+// the graph to verify the structure.
+template <mode Mode>
+void apply_relocations(deserialization_context<Mode> const& c, uint8_t* from) {
+  static_assert((Mode & mode::UNCHECKED) == mode::UNCHECKED);
+  auto const table_start = *reinterpret_cast<offset_t const*>(
+      from + relocations_start(Mode));
+  auto const count_ptr = reinterpret_cast<uint64_t const*>(from + table_start);
+  auto const count = static_cast<size_t>(*count_ptr);
+  auto const positions = reinterpret_cast<offset_t const*>(count_ptr + 1);
+
+  auto const relocate = [&](std::size_t const first, std::size_t const last) {
+    for (auto i = first; i != last; ++i) {
+      c.deserialize(reinterpret_cast<void**>(from + positions[i]));
+    }
+  };
+
+  if (c.parallelism_ > 1U && count >= MIN_PARALLEL_DESERIALIZE) {
+    parallel_for(c.parallelism_, count, relocate);
+  } else {
+    relocate(0U, count);
+  }
+}
+
+// parallelism: number of threads (0 = number of hardware threads).
 template <typename T, mode const Mode = mode::NONE>
-T* deserialize(uint8_t* from, uint8_t* to = nullptr) {
-  check<T, Mode>(from, to);
+T* deserialize(uint8_t* from, uint8_t* to = nullptr,
+               unsigned const parallelism = 1U) {
+  auto const threads =
+      parallelism == 0U ? hardware_parallelism() : parallelism;
+  check<T, Mode>(from, to, threads);
   deserialization_context<Mode> c{from, to};
+  c.parallelism_ = threads;
   auto const el = reinterpret_cast<T*>(from + data_start(Mode));
-  deserialize(c, el);
+  if constexpr ((Mode & mode::WITH_RELOCATIONS) == mode::WITH_RELOCATIONS &&
+                (Mode & mode::UNCHECKED) == mode::UNCHECKED &&
+                !endian_conversion_necessary<Mode>()) {
+    static_assert(!has_custom_deserialize<decltype(c), T>(),
+                  "relocation table: custom deserialize() functions are not "
+                  "called, serialize without mode::WITH_RELOCATIONS");
+    apply_relocations(c, from);
+  } else {
+    deserialize(c, el);
+  }
   return el;
 }
 
 template <typename T, mode const Mode = mode::NONE, typename Container>
-T* deserialize(Container& c) {
-  return deserialize<T, Mode>(&c[0], &c[0] + c.size());
+T* deserialize(Container& c, unsigned const parallelism = 1U) {
+  return deserialize<T, Mode>(c.data(), c.data() + c.size(), parallelism);
 }
 
 template <typename T, mode const Mode = mode::NONE>
-T* unchecked_deserialize(uint8_t* from, uint8_t* to = nullptr) {
-  return deserialize<T, Mode | mode::UNCHECKED>(from, to);
+T* unchecked_deserialize(uint8_t* from, uint8_t* to = nullptr,
+                         unsigned const parallelism = 1U) {
+  return deserialize<T, Mode | mode::UNCHECKED>(from, to, parallelism);
 }
 
 template <typename T, mode const Mode = mode::NONE, typename Container>
-T* unchecked_deserialize(Container& c) {
-  return unchecked_deserialize<T, Mode>(&c[0], &c[0] + c.size());
+T* unchecked_deserialize(Container& c, unsigned const parallelism = 1U) {
+  return unchecked_deserialize<T, Mode>(c.data(), c.data() + c.size(),
+                                        parallelism);
 }
 
 namespace raw {
@@ -0,0 +1,172 @@
+#pragma once
+
+#ifndef _MSC_VER
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+#include "cista/mmap.h"
+#include "cista/targets/file.h"
+#include "cista/verify.h"
+
+// Zero-copy hand-off of serialized (offset mode) data between processes:
+//
+//   Writer:
+//     auto b = cista::buf<cista::mmap>{cista::create_shared_memory()};
+//     cista::serialize<MODE>(b, data);
+//     auto const sealed = cista::seal_shared_memory(std::move(b.buf_));
+//     cista::send_fd(socket, sealed.fd());
+//
+//   Reader:
+//     auto m = cista::open_shared_memory(cista::receive_fd(socket));
+//     auto const d = cista::deserialize<T, MODE>(m);
+//
+// The reader maps the same pages read-only. On Linux, the memfd is sealed
+// before it is sent: nobody (neither the writer nor a reader) can write,
+// shrink or grow it anymore, and open_shared_memory() only accepts sealed
+// file descriptors. The shm_open fallback (other systems) cannot be
+// sealed: the receiver could map it writable and the writer could still
+// modify or truncate it (SIGBUS in the readers). Not available on Windows.
+
+namespace cista {
+
+#if defined(__linux__) && defined(MFD_CLOEXEC) && defined(MFD_ALLOW_SEALING)
+#define CISTA_SEALED_SHARED_MEMORY
+constexpr auto const SHARED_MEMORY_SEALS =
+    F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+#endif
+
+// New unnamed shared memory file descriptor (memfd_create on Linux,
+// shm_open + shm_unlink elsewhere). Closed on exec.
+inline int create_shared_memory_fd(char const* name = "cista") {
+#ifdef CISTA_SEALED_SHARED_MEMORY
+  auto const fd = ::memfd_create(name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  verify(fd != -1, "memfd_create error");
+  return fd;
+#else
+  static std::atomic<unsigned> counter{0U};
+  for (;;) {
+    auto const shm_name = std::string{"/"} + name + "-" +
+                          std::to_string(::getpid()) + "-" +
+                          std::to_string(counter++);
+    auto const fd = ::shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL,
+                               S_IRUSR | S_IWUSR);
+    if (fd == -1 && errno == EEXIST) {
+      continue;
+    }
+    verify(fd != -1, "shm_open error");
+    ::shm_unlink(shm_name.c_str());
+    verify(::fcntl(fd, F_SETFD, FD_CLOEXEC) != -1, "fcntl error");
+    return fd;
+  }
+#endif
+}
+
+// Writable mapping of a new shared memory file, e.g. as buf<mmap> target.
+inline mmap create_shared_memory(char const* name = "cista") {
+  return mmap{file{create_shared_memory_fd(name), "w+"},
+              mmap::protection::WRITE};
+}
+
+// Finishes writing: unmaps the writable mapping, truncates the file to
+// the used size and seals it (Linux). Returns a read-only mapping of the
+// same file, its fd() is the one to pass to send_fd().
+inline mmap seal_shared_memory(mmap&& m) {
+  auto const fd = ::fcntl(m.fd(), F_DUPFD_CLOEXEC, 0);
+  verify(fd != -1, "fcntl dup error");
+  {
+    auto const writable = std::move(m);  // sealing fails if still mapped
+  }
+#ifdef CISTA_SEALED_SHARED_MEMORY
+  if (::fcntl(fd, F_ADD_SEALS, SHARED_MEMORY_SEALS) == -1) {
+    ::close(fd);
+    throw std::runtime_error{"seal error"};
+  }
+#endif
+  return mmap{file{fd, "r"}, mmap::protection::READ};
+}
+
+// Read-only mapping of a shared memory file descriptor (takes ownership).
+// Linux: the file has to be sealed with seal_shared_memory().
+inline mmap open_shared_memory(int const fd) {
+  auto f = file{fd, "r"};
+#ifdef CISTA_SEALED_SHARED_MEMORY
+  auto const seals = ::fcntl(fd, F_GET_SEALS);
+  verify(seals != -1 &&
+             (seals & SHARED_MEMORY_SEALS) == SHARED_MEMORY_SEALS,
+         "shared memory not sealed");
+#endif
+  return mmap{std::move(f), mmap::protection::READ};
+}
+
+// Passes a file descriptor over a Unix domain socket (SCM_RIGHTS).
+inline void send_fd(int const socket, int const fd) {
+  char data = 0;
+  auto io = iovec{&data, sizeof(data)};
+
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+  std::memset(control, 0, sizeof(control));
+
+  auto msg = msghdr{};
+  msg.msg_iov = &io;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  auto const cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+  auto result = ssize_t{0};
+  do {
+    result = ::sendmsg(socket, &msg, 0);
+  } while (result == -1 && errno == EINTR);
+  verify(result == sizeof(data), "sendmsg error");
+}
+
+// Receives a file descriptor sent with send_fd().
+inline int receive_fd(int const socket) {
+  char data = 0;
+  auto io = iovec{&data, sizeof(data)};
+
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+  std::memset(control, 0, sizeof(control));
+
+  auto msg = msghdr{};
+  msg.msg_iov = &io;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  auto result = ssize_t{0};
+  do {
+    result = ::recvmsg(socket, &msg, 0);
+  } while (result == -1 && errno == EINTR);
+  verify(result == sizeof(data), "recvmsg error");
+
+  auto const cmsg = CMSG_FIRSTHDR(&msg);
+  verify(cmsg != nullptr && cmsg->cmsg_level == SOL_SOCKET &&
+             cmsg->cmsg_type == SCM_RIGHTS &&
+             cmsg->cmsg_len == CMSG_LEN(sizeof(int)),
+         "no file descriptor received");
+  auto fd = -1;
+  std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+  return fd;
+}
+
+}  // namespace cista
+
+#endif
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cassert>
+#include <cinttypes>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cista/mmap.h"
+#include "cista/serialization.h"
+
+namespace cista {
+
+// Hot reloading of memory mapped snapshots for read-mostly services.
+//
+// load() / load_async() map and validate (deserialize<T, Mode>) a new file
+// and publish its root with an atomic pointer swap. Old snapshots are
+// unmapped once every registered reader has passed a quiescent state
+// (QSBR): readers pay one atomic load per get() and announce from time
+// to time (e.g. after each request) that they hold no references anymore:
+//
+//   auto r = manager.register_reader();  // once per reader thread
+//   for (;;) {
+//     auto const root = r.get();
+//     ... handle request using root ...
+//     r.quiescent();
+//   }
+//
+// Readers that block for a longer time should go offline() to not delay
+// reclamation. Offset mode snapshots are mapped read-only, raw mode needs
+// protection::PRIVATE (deserialization writes pointers).
+template <typename T, mode const Mode = mode::NONE>
+struct snapshot_manager {
+  static constexpr auto const OFFLINE = std::numeric_limits<uint64_t>::max();
+
+  struct reader {
+    explicit reader(snapshot_manager& m) : m_{&m}, slot_{m.add_slot()} {}
+
+    ~reader() {
+      if (m_ != nullptr) {
+        m_->remove_slot(slot_);
+      }
+    }
+
+    reader(reader const&) = delete;
+    reader& operator=(reader const&) = delete;
+
+    reader(reader&& o) noexcept : m_{o.m_}, slot_{o.slot_} {
+      o.m_ = nullptr;
+    }
+
+    reader& operator=(reader&&) = delete;
+
+    // Current root (nullptr before the first load). Valid until the next
+    // quiescent() or offline() call of this reader. Must not be called
+    // while the reader is offline (call quiescent() first).
+    T const* get() const {
+      assert(slot_->load(std::memory_order_relaxed) != OFFLINE);
+      return m_->root_.load(std::memory_order_acquire);
+    }
+
+    // This reader holds no references to snapshot data. Also brings an
+    // offline reader back online: the fence orders the slot store before
+    // the following get() so that collect() either sees the slot or the
+    // reader sees the root published with the new epoch.
+    void quiescent() {
+      slot_->store(m_->epoch_.load(std::memory_order_seq_cst),
+                   std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    // Stops participating until the next quiescent() call.
+    void offline() { slot_->store(OFFLINE, std::memory_order_release); }
+
+  private:
+    snapshot_manager* m_;
+    std::atomic<uint64_t>* slot_;
+  };
+
+  explicit snapshot_manager(
+      mmap::protection const prot = mmap::protection::READ,
+      mmap::flags const flags = mmap::flags::NONE,
+      unsigned const parallelism = 1U)
+      : prot_{prot}, flags_{flags}, parallelism_{parallelism} {}
+
+  snapshot_manager(snapshot_manager const&) = delete;
+  snapshot_manager& operator=(snapshot_manager const&) = delete;
+
+  // Readers must not outlive the manager.
+  ~snapshot_manager() = default;
+
+  reader register_reader() { return reader{*this}; }
+
+  // Maps and validates the file, then publishes it. Throws (keeping the
+  // current snapshot) if the file is invalid.
+  void load(std::string const& path) {
+    auto s = std::make_unique<snapshot>(mmap{path.c_str(), prot_, flags_});
+    s->root_ = deserialize<T, Mode>(s->mmap_, parallelism_);
+    publish(std::move(s));
+  }
+
+  // load() on a background thread.
+  std::future<void> load_async(std::string path) {
+    return std::async(std::launch::async,
+                      [this, path = std::move(path)]() { load(path); });
+  }
+
+  // Unmaps retired snapshots that are no longer referenced by any reader.
+  // Returns the number of snapshots that are still retired.
+  std::size_t collect() {
+    auto const lock = std::lock_guard{mutex_};
+    std::atomic_thread_fence(std::memory_order_seq_cst);  // see quiescent()
+    auto const min_epoch = min_reader_epoch();
+    retired_.erase(
+        std::remove_if(begin(retired_), end(retired_),
+                       [&](retired const& r) { return r.epoch_ <= min_epoch; }),
+        end(retired_));
+    return retired_.size();
+  }
+
+  // Blocks until all retired snapshots have been unmapped.
+  void synchronize() {
+    while (collect() != 0U) {
+      std::this_thread::yield();
+    }
+  }
+
+  // Number of published snapshots.
+  uint64_t version() const { return epoch_.load(std::memory_order_acquire); }
+
+private:
+  struct snapshot {
+    explicit snapshot(mmap&& m) : mmap_{std::move(m)} {}
+    mmap mmap_;
+    T* root_{nullptr};
+  };
+
+  struct retired {
+    uint64_t epoch_;  // readers at >= epoch_ do not reference snapshot_
+    std::unique_ptr<snapshot> snapshot_;
+  };
+
+  void publish(std::unique_ptr<snapshot> s) {
+    {
+      auto const lock = std::lock_guard{mutex_};
+      root_.store(s->root_, std::memory_order_release);
+      auto const epoch = epoch_.fetch_add(1U, std::memory_order_acq_rel) + 1U;
+      if (current_ != nullptr) {
+        retired_.push_back({epoch, std::move(current_)});
+      }
+      current_ = std::move(s);
+    }
+    collect();
+  }
+
+  uint64_t min_reader_epoch() const {
+    auto min = OFFLINE;
+    for (auto const& slot : slots_) {
+      min = std::min(min, slot.load(std::memory_order_acquire));
+    }
+    return min;
+  }
+
+  std::atomic<uint64_t>* add_slot() {
+    auto const lock = std::lock_guard{mutex_};
+    return &slots_.emplace_back(epoch_.load(std::memory_order_acquire));
+  }
+
+  void remove_slot(std::atomic<uint64_t>* slot) {
+    auto const lock = std::lock_guard{mutex_};
+    slots_.remove_if([&](auto const& s) { return &s == slot; });
+  }
+
+  mmap::protection prot_;
+  mmap::flags flags_;
+  unsigned parallelism_;
+
+  std::atomic<T const*> root_{nullptr};
+  std::atomic<uint64_t> epoch_{0U};
+
+  std::mutex mutex_;
+  std::unique_ptr<snapshot> current_;
+  std::vector<retired> retired_;
+  std::list<std::atomic<uint64_t>> slots_;
+};
+
+}  // namespace cista
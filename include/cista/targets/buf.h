@@ -4,71 +4,129 @@
 #include <cstring>
 #include <memory>
 
+#include "cista/buffer.h"
 #include "cista/chunk.h"
 #include "cista/hash.h"
 #include "cista/offset_t.h"
 #include "cista/serialized_size.h"
 #include "cista/type_hash/type_name.h"
 #include "cista/verify.h"
+#include "cista/word_hash.h"
 
 namespace cista {
 
 constexpr auto const MAX_ALIGN = 16;
-using byte_buf = std::vector<uint8_t>;
+using byte_buf = buffer;
 
 template <typename Buf = byte_buf>
 struct buf {
   buf() { static_assert(std::is_default_constructible_v<Buf>, "default ctor"); }
   explicit buf(Buf&& buf) : buf_{std::forward<Buf>(buf)} {}
 
-  uint8_t* addr(offset_t const offset) { return (&buf_[0]) + offset; }
-  uint8_t* base() { return &buf_[0]; }
+  uint8_t* addr(offset_t const offset) { return buf_.data() + offset; }
+  uint8_t* base() { return buf_.data(); }
 
+  // Preallocates storage for n bytes (e.g. from serialized_size_of()).
+  void reserve(std::size_t const n) { buf_.reserve(n); }
+
+  template <typename Hasher = fnv1a_hasher>
   uint64_t checksum(offset_t const start = 0) const {
-    return hash(std::string_view{
-        reinterpret_cast<char const*>(&buf_[static_cast<size_t>(start)]),
+    auto h = Hasher{};
+    update_hash(h, start);
+    return h.finish();
+  }
+
+  // Feeds the content of [start, end[ into the hasher.
+  template <typename Hasher>
+  void update_hash(Hasher& h, offset_t const start = 0) const {
+    h.update(std::string_view{
+        reinterpret_cast<char const*>(buf_.data()) + start,
         buf_.size() - static_cast<size_t>(start)});
   }
 
+  // Maintains the word_hash of the buffer content from now on.
+  void track_checksum() {
+    word_sum_ = word_sum(base(), buf_.size(), 0U);
+    track_checksum_ = true;
+  }
+
+  // word_hash of [start, end[, requires track_checksum() before writing.
+  uint64_t incremental_checksum(offset_t const start) const {
+    verify(track_checksum_, "checksum not tracked");
+    auto const from = static_cast<std::size_t>(start);
+    verify(from % sizeof(uint64_t) == 0U && from <= buf_.size(),
+           "invalid checksum offset");
+    auto const data = reinterpret_cast<uint8_t const*>(buf_.data());
+    auto const header = word_sum_range(data, 0U, buf_.size(), 0U, from);
+    return word_hash_finish(word_sum_ - header, from / sizeof(uint64_t),
+                            buf_.size() - from);
+  }
+
   template <typename T>
   void write(std::size_t const pos, T const& val) {
     verify(buf_.size() >= pos + serialized_size<T>(), "out of bounds write");
-    std::memcpy(&buf_[pos], &val, serialized_size<T>());
+    if (track_checksum_) {
+      word_sum_ += word_sum_write(base(), 0U, buf_.size(), pos, &val,
+                                  serialized_size<T>());
+    } else {
+      std::memcpy(buf_.data() + pos, &val, serialized_size<T>());
+    }
   }
 
   offset_t write(void const* ptr, std::size_t const size,
                  std::size_t alignment = 0) {
-    auto aligned_size = size;
+    auto padding = std::size_t{0U};
 
+    // Align relative to the start of the buffer (not the address in memory)
+    // so the layout does not depend on where the buffer is allocated.
     if (alignment != 0 && alignment != 1 && buf_.size() != 0) {
-      auto unaligned_ptr = static_cast<void*>(addr(curr_offset_));
+      auto unaligned_ptr = reinterpret_cast<void*>(
+          static_cast<std::uintptr_t>(curr_offset_));
       auto space = std::numeric_limits<std::size_t>::max();
       auto const aligned_ptr =
           std::align(alignment, size, unaligned_ptr, space);
       auto const new_offset = static_cast<offset_t>(
-          aligned_ptr ? static_cast<uint8_t*>(aligned_ptr) - base() : 0);
-      auto const adjustment =
-          static_cast<std::size_t>(new_offset - curr_offset_);
-      curr_offset_ += adjustment;
-      aligned_size += adjustment;
+          aligned_ptr ? reinterpret_cast<std::uintptr_t>(aligned_ptr)
+                      : static_cast<std::uintptr_t>(curr_offset_));
+      padding = static_cast<std::size_t>(new_offset - curr_offset_);
     }
 
-    auto const space_left =
-        static_cast<int64_t>(buf_.size()) - static_cast<int64_t>(curr_offset_);
-    if (space_left < static_cast<int64_t>(aligned_size)) {
-      auto const missing = static_cast<std::size_t>(
-          static_cast<int64_t>(aligned_size) - space_left);
-      buf_.resize(buf_.size() + missing);
+    auto const begin = static_cast<std::size_t>(curr_offset_);
+    auto const end = begin + padding + size;
+    auto const before = checksum_range(begin, end);
+    if (buf_.size() < end) {
+      buf_.resize(end);
+    }
+
+    // Buf may not zero-initialize memory (e.g. cista::buffer).
+    if (padding != 0U) {
+      std::memset(addr(curr_offset_), 0, padding);
+      curr_offset_ += static_cast<offset_t>(padding);
     }
 
     auto const start = curr_offset_;
     std::memcpy(addr(curr_offset_), ptr, size);
-    curr_offset_ += size;
+    curr_offset_ += static_cast<offset_t>(size);
+    update_checksum(before, begin, end);
     return start;
   }
 
+  uint64_t checksum_range(std::size_t const from, std::size_t const to) {
+    return track_checksum_ ? word_sum_range(base(), 0U, buf_.size(), from, to)
+                           : 0U;
+  }
+
+  void update_checksum(uint64_t const before, std::size_t const from,
+                       std::size_t const to) {
+    if (track_checksum_) {
+      word_sum_ += checksum_range(from, to) - before;
+    }
+  }
+
   Buf buf_;
   offset_t curr_offset_{0};
+  bool track_checksum_{false};
+  uint64_t word_sum_{0U};
   FILE* f_;
 };
 
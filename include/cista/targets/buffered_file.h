@@ -0,0 +1,342 @@
+#pragma once
+
+#ifndef _MSC_VER
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "cista/buffer.h"
+#include "cista/chunk.h"
+#include "cista/hash.h"
+#include "cista/offset_t.h"
+#include "cista/serialized_size.h"
+#include "cista/targets/file.h"
+#include "cista/verify.h"
+#include "cista/word_hash.h"
+
+namespace cista {
+
+// File target with a user-space buffer for the append stream.
+// - write(ptr, size, alignment) appends to the buffer, full buffers are
+//   written with a single positional write (pwrite).
+// - write(pos, val) patches the buffer in memory if pos is still buffered.
+//   Otherwise, the patch is recorded and all recorded patches are written
+//   sorted by position (nearby patches batched) on the next flush().
+//   Overlapping patches are applied in call order.
+// - The buffer always starts at a multiple of 8 bytes (a trailing partial
+//   word stays buffered after flush()) so the incremental word_hash
+//   (track_checksum()) can be maintained for in-memory writes. Deltas of
+//   recorded patches are computed when they are applied.
+// - The destructor flushes remaining data but ignores errors (like the
+//   file target closing its handle). Call flush() to have them reported.
+struct buffered_file {
+  static constexpr auto const DEFAULT_BUFFER_SIZE = std::size_t{8U << 20U};
+
+  explicit buffered_file(char const* path,
+                         std::size_t const buffer_size = DEFAULT_BUFFER_SIZE)
+      : f_{path, "w+"}, buf_(std::max(buffer_size, std::size_t{4096U})) {}
+
+  ~buffered_file() {
+    if (f_.f_ != nullptr) {
+      try {
+        flush();
+      } catch (...) {
+      }
+    }
+  }
+
+  buffered_file(buffered_file const&) = delete;
+  buffered_file& operator=(buffered_file const&) = delete;
+
+  buffered_file(buffered_file&&) = default;
+
+  // Flushes (and closes) the current file before taking over o.
+  buffered_file& operator=(buffered_file&& o) {
+    if (this != &o) {
+      if (f_.f_ != nullptr) {
+        flush();
+        auto const current = file{std::move(f_)};
+      }
+      f_ = std::move(o.f_);
+      buf_ = std::move(o.buf_);
+      used_ = std::exchange(o.used_, 0U);
+      flushed_ = std::exchange(o.flushed_, 0U);
+      patches_ = std::move(o.patches_);
+      patch_data_ = std::move(o.patch_data_);
+      track_checksum_ = std::exchange(o.track_checksum_, false);
+      word_sum_ = std::exchange(o.word_sum_, 0U);
+    }
+    return *this;
+  }
+
+  std::size_t size() const { return flushed_ + used_; }
+
+  void flush() {
+    if (used_ != 0U) {
+      write_at(buf_.data(), used_, flushed_);
+      auto const tail = used_ % sizeof(uint64_t);
+      std::memmove(buf_.data(), buf_.data() + used_ - tail, tail);
+      flushed_ += used_ - tail;
+      used_ = tail;
+    }
+    write_patches();
+  }
+
+  // Maintains the word_hash of the file content from now on.
+  void track_checksum() {
+    verify(size() == 0U, "checksum tracking has to start before writing");
+    track_checksum_ = true;
+  }
+
+  // word_hash of [start, end[, requires track_checksum() before writing.
+  uint64_t incremental_checksum(offset_t const start) {
+    verify(track_checksum_, "checksum not tracked");
+    auto const from = static_cast<std::size_t>(start);
+    verify(from % sizeof(uint64_t) == 0U && from <= size(),
+           "invalid checksum offset");
+    flush();
+
+    auto header = std::vector<uint8_t>(from);
+    read_at(header.data(), from, 0U);
+    return word_hash_finish(word_sum_ - word_sum(header.data(), from, 0U),
+                            from / sizeof(uint64_t), size() - from);
+  }
+
+  template <typename Hasher = fnv1a_hasher>
+  uint64_t checksum(offset_t const start = 0) {
+    auto h = Hasher{};
+    update_hash(h, start);
+    return h.finish();
+  }
+
+  // Feeds the content of [start, end[ into the hasher.
+  template <typename Hasher>
+  void update_hash(Hasher& h, offset_t const start = 0) {
+    flush();
+
+    constexpr auto const block_size = static_cast<size_t>(512 * 1024);
+    verify(size() >= static_cast<size_t>(start), "invalid checksum offset");
+    auto read_buf = buffer(block_size);
+    chunk(block_size, size() - static_cast<size_t>(start),
+          [&](auto const from, auto const s) {
+            read_at(read_buf.data(), s, static_cast<size_t>(start) + from);
+            h.update(read_buf.data(), s);
+          });
+  }
+
+  template <typename T>
+  void write(std::size_t const pos, T const& val) {
+    constexpr auto const n = serialized_size<T>();
+    verify(pos + n <= size(), "out of bounds write");
+
+    auto const src = reinterpret_cast<uint8_t const*>(&val);
+    auto const on_disk = pos < flushed_ ? std::min(n, flushed_ - pos) : 0U;
+    if (on_disk != 0U) {
+      patches_.push_back({pos, patch_data_.size(), on_disk});
+      patch_data_.insert(end(patch_data_), src, src + on_disk);
+    }
+    if (on_disk != n) {
+      auto const offset = pos + on_disk - flushed_;
+      if (track_checksum_) {
+        word_sum_ += word_sum_write(buf_.data(), flushed_, used_, offset,
+                                    src + on_disk, n - on_disk);
+      } else {
+        std::memcpy(buf_.data() + offset, src + on_disk, n - on_disk);
+      }
+    }
+  }
+
+  offset_t write(void const* ptr, std::size_t const size,
+                 std::size_t alignment = 0) {
+    auto curr_offset = this->size();
+    if (alignment != 0 && alignment != 1) {
+      auto unaligned_ptr = reinterpret_cast<void*>(curr_offset);
+      auto space = std::numeric_limits<std::size_t>::max();
+      auto const aligned_ptr =
+          std::align(alignment, size, unaligned_ptr, space);
+      curr_offset = aligned_ptr ? reinterpret_cast<std::uintptr_t>(aligned_ptr)
+                                : curr_offset;
+    }
+
+    append_padding(curr_offset - this->size());
+    append(static_cast<uint8_t const*>(ptr), size);
+    return static_cast<offset_t>(curr_offset);
+  }
+
+  file f_;
+
+private:
+  struct patch {
+    std::size_t pos_;
+    std::size_t data_offset_;
+    std::size_t size_;
+  };
+
+  // Zero padding does not change the word_hash (bytes beyond the end of the
+  // file count as zero).
+  void append_padding(std::size_t n) {
+    while (n != 0U) {
+      if (used_ == buf_.size()) {
+        flush();
+      }
+      auto const s = std::min(n, buf_.size() - used_);
+      std::memset(buf_.data() + used_, 0, s);
+      used_ += s;
+      n -= s;
+    }
+  }
+
+  void append(uint8_t const* ptr, std::size_t size) {
+    while (size != 0U) {
+      if (used_ == buf_.size()) {
+        flush();
+      }
+      auto const n = std::min(size, buf_.size() - used_);
+      auto const before = buffer_sum(used_, used_ + n, used_);
+      std::memcpy(buf_.data() + used_, ptr, n);
+      word_sum_ += buffer_sum(used_, used_ + n, used_ + n) - before;
+      used_ += n;
+      ptr += n;
+      size -= n;
+    }
+  }
+
+  uint64_t buffer_sum(std::size_t const from, std::size_t const to,
+                      std::size_t const valid) const {
+    return track_checksum_
+               ? word_sum_range(buf_.data(), flushed_, valid, from, to)
+               : 0U;
+  }
+
+  void write_patches() {
+    if (patches_.empty()) {
+      return;
+    }
+
+    std::sort(begin(patches_), end(patches_),
+              [](patch const& a, patch const& b) { return a.pos_ < b.pos_; });
+
+    // Patches closer than MAX_GAP are merged into one read-modify-write of
+    // the whole range: a few large I/O calls instead of one per pointer.
+    // With checksum tracking, ranges are extended to whole words and always
+    // read to compute the checksum delta.
+    constexpr auto const MAX_GAP = std::size_t{64U * 1024U};
+    constexpr auto const MAX_RANGE = std::size_t{16U << 20U};
+    constexpr auto const WORD = sizeof(uint64_t);
+
+    std::vector<uint8_t> range;
+    for (auto first = begin(patches_); first != end(patches_);) {
+      auto range_start = first->pos_;
+      auto range_end = first->pos_ + first->size_;
+      auto last = std::next(first);
+      while (last != end(patches_) && last->pos_ <= range_end + MAX_GAP &&
+             last->pos_ + last->size_ - range_start <= MAX_RANGE) {
+        range_end = std::max(range_end, last->pos_ + last->size_);
+        ++last;
+      }
+
+      if (track_checksum_) {
+        range_start -= range_start % WORD;
+        range_end = std::min(flushed_, (range_end + WORD - 1U) / WORD * WORD);
+      }
+
+      range.resize(range_end - range_start);
+      if (track_checksum_ || std::next(first) != last) {
+        read_at(range.data(), range.size(), range_start);
+        std::sort(first, last, [](patch const& a, patch const& b) {
+          return a.data_offset_ < b.data_offset_;  // call order
+        });
+      }
+      for (auto it = first; it != last; ++it) {
+        auto const src = patch_data_.data() + it->data_offset_;
+        auto const from = it->pos_ - range_start;
+        if (track_checksum_) {
+          word_sum_ += word_sum_write(range.data(), range_start, range.size(),
+                                      from, src, it->size_);
+        } else {
+          std::memcpy(range.data() + from, src, it->size_);
+        }
+      }
+      write_at(range.data(), range.size(), range_start);
+
+      first = last;
+    }
+
+    patches_.clear();
+    patch_data_.clear();
+  }
+
+  void write_at(void const* ptr, std::size_t size, std::size_t pos) {
+    auto data = static_cast<uint8_t const*>(ptr);
+    while (size != 0U) {
+#ifdef _MSC_VER
+      OVERLAPPED overlapped = {0};
+      overlapped.Offset = static_cast<DWORD>(pos);
+      overlapped.OffsetHigh = static_cast<DWORD>(pos >> 32U);
+      DWORD bytes_written = {0};
+      auto const to_write = static_cast<DWORD>(
+          std::min(size, std::size_t{std::numeric_limits<DWORD>::max()}));
+      verify(WriteFile(f_.f_, data, to_write, &bytes_written, &overlapped),
+             "pwrite error");
+      auto const written = static_cast<std::size_t>(bytes_written);
+#else
+      auto const result =
+          ::pwrite(f_.fd(), data, size, static_cast<off_t>(pos));
+      if (result == -1 && errno == EINTR) {
+        continue;
+      }
+      verify(result > 0, "pwrite error");
+      auto const written = static_cast<std::size_t>(result);
+#endif
+      data += written;
+      pos += written;
+      size -= written;
+    }
+  }
+
+  void read_at(void* ptr, std::size_t size, std::size_t pos) const {
+    auto data = static_cast<uint8_t*>(ptr);
+    while (size != 0U) {
+#ifdef _MSC_VER
+      OVERLAPPED overlapped = {0};
+      overlapped.Offset = static_cast<DWORD>(pos);
+      overlapped.OffsetHigh = static_cast<DWORD>(pos >> 32U);
+      DWORD bytes_read = {0};
+      verify(ReadFile(f_.f_, data, static_cast<DWORD>(size), &bytes_read,
+                      &overlapped),
+             "pread error");
+      auto const read = static_cast<std::size_t>(bytes_read);
+#else
+      auto const result = ::pread(f_.fd(), data, size, static_cast<off_t>(pos));
+      if (result == -1 && errno == EINTR) {
+        continue;
+      }
+      verify(result > 0, "pread error");
+      auto const read = static_cast<std::size_t>(result);
+#endif
+      data += read;
+      pos += read;
+      size -= read;
+    }
+  }
+
+  buffer buf_;
+  std::size_t used_{0U};
+  std::size_t flushed_{0U};
+  std::vector<patch> patches_;
+  std::vector<uint8_t> patch_data_;
+  bool track_checksum_{false};
+  uint64_t word_sum_{0U};
+};
+
+}  // namespace cista
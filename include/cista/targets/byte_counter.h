@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cinttypes>
+#include <limits>
+#include <memory>
+
+#include "cista/offset_t.h"
+
+namespace cista {
+
+// Serialization target that writes nothing and only tracks the output size.
+// Padding is computed exactly like buf<> and file do (relative to offset 0).
+struct byte_counter {
+  template <typename Hasher = void>
+  uint64_t checksum(offset_t const = 0) const {
+    return 0U;
+  }
+
+  template <typename Hasher>
+  void update_hash(Hasher&, offset_t const = 0) const {}
+
+  template <typename T>
+  void write(std::size_t const, T const&) {}
+
+  offset_t write(void const*, std::size_t const size,
+                 std::size_t alignment = 0) {
+    auto curr_offset = size_;
+    if (alignment != 0 && alignment != 1 && size_ != 0) {
+      auto unaligned_ptr = reinterpret_cast<void*>(size_);
+      auto space = std::numeric_limits<std::size_t>::max();
+      auto const aligned_ptr =
+          std::align(alignment, size, unaligned_ptr, space);
+      curr_offset = aligned_ptr ? reinterpret_cast<std::uintptr_t>(aligned_ptr)
+                                : curr_offset;
+    }
+    size_ = curr_offset + size;
+    return static_cast<offset_t>(curr_offset);
+  }
+
+  std::size_t size_{0U};
+};
+
+}  // namespace cista
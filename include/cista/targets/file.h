@@ -12,6 +12,7 @@
 #endif
 
 #include <cinttypes>
+#include <algorithm>
 #include <memory>
 
 #include "cista/buffer.h"
@@ -92,9 +93,17 @@ struct file {
     return b;
   }
 
+  template <typename Hasher = fnv1a_hasher>
   uint64_t checksum(offset_t const start = 0) const {
+    auto h = Hasher{};
+    update_hash(h, start);
+    return h.finish();
+  }
+
+  // Feeds the content of [start, end[ into the hasher.
+  template <typename Hasher>
+  void update_hash(Hasher& h, offset_t const start = 0) const {
     constexpr auto const block_size = 512 * 1024;  // 512kB
-    auto c = BASE_HASH;
     char buf[block_size];
     chunk(block_size, size_ - static_cast<size_t>(start),
           [&](auto const from, auto const size) {
@@ -106,9 +115,8 @@ struct file {
                             &overlapped),
                    "checksum read error");
             verify(bytes_read == size, "checksum read error bytes read");
-            c = hash(std::string_view{buf, size}, c);
+            h.update(buf, size);
           });
-    return c;
   }
 
   template <typename T>
@@ -135,10 +143,11 @@ struct file {
                                 : curr_offset;
     }
 
-    unsigned char const buf[16] = {0};
-    auto const num_padding_bytes = static_cast<DWORD>(curr_offset - size_);
-    if (num_padding_bytes != 0U) {
-      verify(num_padding_bytes < 16, "invalid padding size");
+    // Padding can be larger than the buffer (e.g. page alignment).
+    unsigned char const buf[256] = {0};
+    while (size_ != curr_offset) {
+      auto const num_padding_bytes =
+          static_cast<DWORD>(std::min(curr_offset - size_, sizeof(buf)));
       OVERLAPPED overlapped = {0};
       overlapped.Offset = static_cast<uint32_t>(size_);
       overlapped.OffsetHigh = static_cast<uint32_t>(size_ >> 32u);
@@ -147,7 +156,7 @@ struct file {
              "write padding error");
       verify(bytes_written == num_padding_bytes,
              "write padding error bytes written");
-      size_ = curr_offset;
+      size_ += num_padding_bytes;
     }
 
     constexpr auto block_size = 8192u;
@@ -186,6 +195,11 @@ struct file {
     verify(f_ != nullptr, "unable to open file");
   }
 
+  // Takes ownership of an open file descriptor.
+  file(int const fd, char const* mode) : f_{::fdopen(fd, mode)}, size_{size()} {
+    verify(f_ != nullptr, "unable to open file descriptor");
+  }
+
   ~file() {
     if (f_ != nullptr) {
       std::fclose(f_);
@@ -231,18 +245,25 @@ struct file {
     return b;
   }
 
+  template <typename Hasher = fnv1a_hasher>
   uint64_t checksum(offset_t const start = 0) const {
+    auto h = Hasher{};
+    update_hash(h, start);
+    return h.finish();
+  }
+
+  // Feeds the content of [start, end[ into the hasher.
+  template <typename Hasher>
+  void update_hash(Hasher& h, offset_t const start = 0) const {
     constexpr auto const block_size = static_cast<size_t>(512 * 1024);  // 512kB
     verify(size_ >= static_cast<size_t>(start), "invalid checksum offset");
     verify(!std::fseek(f_, static_cast<long>(start), SEEK_SET), "fseek error");
-    auto c = BASE_HASH;
     char buf[block_size];
     chunk(block_size, size_ - static_cast<size_t>(start),
           [&](auto const, auto const s) {
             verify(std::fread(buf, 1, s, f_) == s, "invalid read");
-            c = hash(std::string_view{buf, s}, c);
+            h.update(buf, s);
           });
-    return c;
   }
 
   template <typename T>
@@ -1,80 +1,172 @@
 #pragma once
 
 #include <map>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "cista/containers.h"
 #include "cista/decay.h"
 #include "cista/hash.h"
-#include "cista/reflection/for_each_field.h"
+#include "cista/reflection/to_tuple.h"
 #include "cista/type_hash/type_name.h"
 
 namespace cista {
 
+// The type hash is computed at compile time from the reflected field
+// structure. Types are passed as (null) pointers because containers are
+// not literal types. Custom overloads follow the same pattern:
+//
+//   template <typename Done>
+//   constexpr hash_t type_hash(my_type const*, hash_t h, Done& done);
+
 template <typename T>
-hash_t type2str_hash() {
-  return hash(canonical_type_str<decay_t<T>>());
+constexpr hash_t type2str_hash() {
+  return hash(canonical_type_name<decay_t<T>>().view());
 }
 
+// Types that have already been hashed (in order of their first
+// occurrence). Repeated occurrences contribute their index instead of
+// their structure which terminates the recursion for recursive types.
+template <std::size_t MaxTypes>
+struct type_hash_done {
+  // Returns the index of the type and whether it was inserted.
+  constexpr std::pair<unsigned, bool> try_emplace(hash_t const base_hash) {
+    for (auto i = 0U; i != size_; ++i) {
+      if (hashes_[i] == base_hash) {
+        return {i, false};
+      }
+    }
+    if (size_ == MaxTypes) {
+      overflow_ = true;
+      return {size_, false};
+    }
+    hashes_[size_] = base_hash;
+    return {size_++, true};
+  }
+
+  hash_t hashes_[MaxTypes]{};
+  unsigned size_{0U};
+  bool overflow_{false};
+};
+
+// Detects overloads with the signature used before the type hash was
+// computed at compile time. They would be silently ignored (the hash of
+// the reflected structure would be used instead).
+template <typename T, typename = void>
+struct has_legacy_type_hash : std::false_type {};
+
 template <typename T>
-hash_t type_hash(T const& el, hash_t h, std::map<hash_t, unsigned>& done) {
+struct has_legacy_type_hash<
+    T, std::void_t<decltype(type_hash(
+           std::declval<T const&>(), hash_t{},
+           std::declval<std::map<hash_t, unsigned>&>()))>> : std::true_type {};
+
+template <typename T, typename Done>
+constexpr hash_t type_hash(T const*, hash_t h, Done& done);
+
+template <typename Tuple, typename Done, std::size_t... I>
+constexpr hash_t type_hash_fields(hash_t h, Done& done,
+                                  std::index_sequence<I...>) {
+  ((h = type_hash(static_cast<std::remove_reference_t<
+                      std::tuple_element_t<I, Tuple>> const*>(nullptr),
+                  h, done)),
+   ...);
+  return h;
+}
+
+template <typename T, typename Done>
+constexpr hash_t type_hash(T const*, hash_t h, Done& done) {
   using Type = decay_t<T>;
 
   auto const base_hash = type2str_hash<Type>();
-  auto [it, inserted] =
-      done.try_emplace(base_hash, static_cast<unsigned>(done.size()));
+  auto const [index, inserted] = done.try_emplace(base_hash);
   if (!inserted) {
-    return hash_combine(h, it->second);
+    return hash_combine(h, index);
   }
 
   if constexpr (is_pointer_v<Type>) {
-    return type_hash(remove_pointer_t<Type>{}, hash_combine(h, hash("pointer")),
-                     done);
+    return type_hash(static_cast<remove_pointer_t<Type> const*>(nullptr),
+                     hash_combine(h, hash("pointer")), done);
   } else if constexpr (std::is_scalar_v<Type>) {
-    return hash_combine(h, type2str_hash<T>());
+    return hash_combine(h, base_hash);
   } else {
+    static_assert(!has_legacy_type_hash<Type>::value,
+                  "type_hash(T const&, hash_t, std::map<hash_t, unsigned>&) "
+                  "is no longer called, migrate it to "
+                  "constexpr type_hash(T const*, hash_t, Done&)");
     static_assert(std::is_aggregate_v<Type> &&
                       std::is_standard_layout_v<Type> &&
                       !std::is_polymorphic_v<Type>,
                   "Please implement custom type hash.");
-    h = hash_combine(h, hash("struct"));
-    for_each_field(el,
-                   [&](auto const& member) { h = type_hash(member, h, done); });
-    return h;
+    using fields_t = decltype(to_tuple(std::declval<Type&>()));
+    return type_hash_fields<fields_t>(
+        hash_combine(h, hash("struct")), done,
+        std::make_index_sequence<std::tuple_size_v<fields_t>>());
   }
 }
 
-template <typename T, size_t Size>
-hash_t type_hash(array<T, Size> const&, hash_t h,
-                 std::map<hash_t, unsigned>& done) {
+template <typename T, size_t Size, typename Done>
+constexpr hash_t type_hash(array<T, Size> const*, hash_t h, Done& done) {
   h = hash_combine(h, hash("array"));
   h = hash_combine(h, Size);
-  return type_hash(T{}, h, done);
+  return type_hash(static_cast<T const*>(nullptr), h, done);
 }
 
-template <typename T, typename Ptr, typename TemplateSizeType>
-hash_t type_hash(basic_vector<T, Ptr, TemplateSizeType> const&, hash_t h,
-                 std::map<hash_t, unsigned>& done) {
+template <typename T, typename Ptr, typename TemplateSizeType,
+          typename Done>
+constexpr hash_t type_hash(basic_vector<T, Ptr, TemplateSizeType> const*,
+                           hash_t h, Done& done) {
   h = hash_combine(h, hash("vector"));
-  return type_hash(T{}, h, done);
+  if constexpr (sizeof(TemplateSizeType) != sizeof(uint32_t)) {
+    h = hash_combine(h, sizeof(TemplateSizeType));  // keep 32bit hashes
+  }
+  return type_hash(static_cast<T const*>(nullptr), h, done);
+}
+
+template <typename T, template <typename> typename Ptr, typename GetKey,
+          typename GetValue, typename Hash, typename Eq, typename Done>
+constexpr hash_t type_hash(
+    hash_storage<T, Ptr, GetKey, GetValue, Hash, Eq> const*, hash_t h,
+    Done& done) {
+  h = hash_combine(h, hash("hash_storage"));
+  return type_hash(static_cast<T const*>(nullptr), h, done);
 }
 
-template <typename T, typename Ptr>
-hash_t type_hash(basic_unique_ptr<T, Ptr> const&, hash_t h,
-                 std::map<hash_t, unsigned>& done) {
+template <typename T, typename Ptr, typename Done>
+constexpr hash_t type_hash(basic_unique_ptr<T, Ptr> const*, hash_t h,
+                           Done& done) {
   h = hash_combine(h, hash("unique_ptr"));
-  return type_hash(T{}, h, done);
+  return type_hash(static_cast<T const*>(nullptr), h, done);
 }
 
-template <typename Ptr>
-hash_t type_hash(basic_string<Ptr> const&, hash_t h,
-                 std::map<hash_t, unsigned>&) {
-  return hash_combine(h, hash("string"));
+template <typename Ptr, typename SizeType, typename Done>
+constexpr hash_t type_hash(basic_string<Ptr, SizeType> const*, hash_t h,
+                           Done&) {
+  h = hash_combine(h, hash("string"));
+  if constexpr (sizeof(SizeType) != sizeof(uint32_t)) {
+    h = hash_combine(h, sizeof(SizeType));  // keep 32bit hashes
+  }
+  return h;
 }
 
-template <typename T>
-hash_t type_hash() {
-  auto done = std::map<hash_t, unsigned>{};
-  return type_hash(T{}, BASE_HASH, done);
+// Returns the type hash and whether MaxTypes was sufficient.
+template <typename T, std::size_t MaxTypes>
+constexpr std::pair<hash_t, bool> bounded_type_hash() {
+  auto done = type_hash_done<MaxTypes>{};
+  auto const h =
+      type_hash(static_cast<decay_t<T> const*>(nullptr), BASE_HASH, done);
+  return {h, !done.overflow_};
+}
+
+template <typename T, std::size_t MaxTypes = 64U>
+constexpr hash_t type_hash() {
+  constexpr auto const result = bounded_type_hash<T, MaxTypes>();
+  if constexpr (result.second) {
+    return result.first;
+  } else {
+    return type_hash<T, 2U * MaxTypes>();
+  }
 }
 
 }  // namespace cista
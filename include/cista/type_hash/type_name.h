@@ -16,6 +16,16 @@ namespace cista {
 #error unsupported compiler
 #endif
 
+// Parts of type names that differ between compilers.
+constexpr std::string_view const TYPE_NAME_REMOVALS[] = {
+    "{anonymous}::",  // GCC
+    "(anonymous namespace)::",  // Clang
+    "`anonymous-namespace'::",  // MSVC
+    "struct",  // MSVC "struct my_struct" vs "my_struct"
+    "const",  // MSVC "char const*"" vs "const char*"
+    " "  // MSVC
+};
+
 inline void remove_all(std::string& s, std::string_view substr) {
   auto pos = std::size_t{};
   while ((pos = s.find(substr, pos)) != std::string::npos) {
@@ -24,14 +34,30 @@ inline void remove_all(std::string& s, std::string_view substr) {
 }
 
 inline void canonicalize_type_name(std::string& s) {
-  remove_all(s, "{anonymous}::");  // GCC
-  remove_all(s, "(anonymous namespace)::");  // Clang
-  remove_all(s, "`anonymous-namespace'::");  // MSVC
-  remove_all(s, "struct");  // MSVC "struct my_struct" vs "my_struct"
-  remove_all(s, "const");  // MSVC "char const*"" vs "const char*"
-  remove_all(s, " ");  // MSVC
+  for (auto const removal : TYPE_NAME_REMOVALS) {
+    remove_all(s, removal);
+  }
 }
 
+// Fixed capacity string for type names computed at compile time.
+template <std::size_t N>
+struct type_name_buf {
+  constexpr std::string_view view() const { return {data_, size_}; }
+
+  constexpr void remove_all(std::string_view const substr) {
+    auto pos = std::size_t{};
+    while ((pos = view().find(substr, pos)) != std::string_view::npos) {
+      for (auto i = pos; i + substr.size() < size_; ++i) {
+        data_[i] = data_[i + substr.size()];
+      }
+      size_ -= substr.size();
+    }
+  }
+
+  char data_[N]{};
+  std::size_t size_{0U};
+};
+
 template <typename T>
 constexpr std::string_view type_str() {
 #if defined(__clang__)
@@ -56,14 +82,28 @@ constexpr std::string_view type_str() {
   return sig;
 }
 
+// Same as canonicalize_type_name(type_str<T>()), usable in constant
+// expressions.
 template <typename T>
-std::string canonical_type_str() {
-  auto const base = type_str<T>();
-  std::string s{base.data(), base.length()};
-  canonicalize_type_name(s);
+constexpr auto canonical_type_name() {
+  constexpr auto const base = type_str<T>();
+  auto s = type_name_buf<base.size()>{};
+  for (auto i = std::size_t{0U}; i != base.size(); ++i) {
+    s.data_[i] = base[i];
+  }
+  s.size_ = base.size();
+  for (auto const removal : TYPE_NAME_REMOVALS) {
+    s.remove_all(removal);
+  }
   return s;
 }
 
+template <typename T>
+std::string canonical_type_str() {
+  constexpr auto const name = canonical_type_name<T>();
+  return std::string{name.view()};
+}
+
 }  // namespace cista
 
 #undef CISTA_SIG
\ No newline at end of file
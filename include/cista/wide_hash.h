@@ -0,0 +1,303 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+
+#if defined(__AVX2__)
+#define CISTA_WIDE_HASH_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CISTA_WIDE_HASH_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "cista/endian/detection.h"
+#include "cista/hash.h"
+
+namespace cista {
+
+// 64bit checksum for large buffers (structure based on XXH3):
+// Input is processed in 64 byte stripes with eight independent 64bit
+// accumulators (acc[i] += lo32(v ^ key) * hi32(v ^ key), acc[i ^ 1] += v),
+// which are scrambled every 1024 bytes. A partial last stripe is zero
+// padded; the input length is mixed into the result.
+// The AVX2 / SSE2 and scalar implementations produce identical results.
+namespace wide_hash_detail {
+
+constexpr auto const STRIPE_SIZE = std::size_t{64U};
+constexpr auto const LANES = std::size_t{8U};
+constexpr auto const STRIPES_PER_BLOCK = std::size_t{16U};
+
+constexpr auto const PRIME32_1 = uint32_t{0x9E3779B1U};
+constexpr auto const PRIME32_2 = uint64_t{0x85EBCA77U};
+constexpr auto const PRIME32_3 = uint64_t{0xC2B2AE3DU};
+constexpr auto const PRIME64_1 = uint64_t{0x9E3779B185EBCA87ULL};
+constexpr auto const PRIME64_2 = uint64_t{0xC2B2AE3D27D4EB4FULL};
+constexpr auto const PRIME64_3 = uint64_t{0x165667B19E3779F9ULL};
+constexpr auto const PRIME64_4 = uint64_t{0x85EBCA77C2B2AE63ULL};
+constexpr auto const PRIME64_5 = uint64_t{0x27D4EB2F165667C5ULL};
+
+alignas(32) constexpr uint64_t const KEYS[LANES] = {
+    0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL,
+    0x1F67B3B7A4A44072ULL, 0x78E5C0CC4EE679CBULL, 0x2172FFCC7DD05A82ULL,
+    0x8E2443F7744608B8ULL, 0x4C263A81E69035E0ULL};
+
+inline uint64_t read64(uint8_t const* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+#ifdef CISTA_BIG_ENDIAN
+  v = ((v & 0x00000000000000FFULL) << 56U) |
+      ((v & 0x000000000000FF00ULL) << 40U) |
+      ((v & 0x0000000000FF0000ULL) << 24U) |
+      ((v & 0x00000000FF000000ULL) << 8U) |
+      ((v & 0x000000FF00000000ULL) >> 8U) |
+      ((v & 0x0000FF0000000000ULL) >> 24U) |
+      ((v & 0x00FF000000000000ULL) >> 40U) |
+      ((v & 0xFF00000000000000ULL) >> 56U);
+#endif
+  return v;
+}
+
+inline void accumulate_scalar(uint64_t* acc, uint8_t const* p,
+                              std::size_t const n_stripes) {
+  for (auto s = std::size_t{0U}; s != n_stripes; ++s, p += STRIPE_SIZE) {
+    for (auto i = std::size_t{0U}; i != LANES; ++i) {
+      auto const v = read64(p + i * sizeof(uint64_t));
+      auto const k = v ^ KEYS[i];
+      acc[i ^ 1U] += v;
+      acc[i] += (k & 0xFFFFFFFFULL) * (k >> 32U);
+    }
+  }
+}
+
+inline void scramble_scalar(uint64_t* acc) {
+  for (auto i = std::size_t{0U}; i != LANES; ++i) {
+    auto a = acc[i];
+    a ^= a >> 47U;
+    a ^= KEYS[i];
+    a *= PRIME32_1;
+    acc[i] = a;
+  }
+}
+
+#if defined(CISTA_WIDE_HASH_AVX2)
+inline void accumulate_simd(uint64_t* acc, uint8_t const* p,
+                            std::size_t const n_stripes) {
+  auto const acc_ptr = reinterpret_cast<__m256i*>(acc);
+  auto a0 = _mm256_loadu_si256(acc_ptr);
+  auto a1 = _mm256_loadu_si256(acc_ptr + 1);
+  auto const k0 = _mm256_load_si256(reinterpret_cast<__m256i const*>(KEYS));
+  auto const k1 =
+      _mm256_load_si256(reinterpret_cast<__m256i const*>(KEYS) + 1);
+  auto const lane = [](__m256i a, __m256i const d, __m256i const k) {
+    auto const dk = _mm256_xor_si256(d, k);
+    auto const product = _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32));
+    auto const swapped = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm256_add_epi64(a, _mm256_add_epi64(product, swapped));
+  };
+  for (auto s = std::size_t{0U}; s != n_stripes; ++s, p += STRIPE_SIZE) {
+    auto const in = reinterpret_cast<__m256i const*>(p);
+    a0 = lane(a0, _mm256_loadu_si256(in), k0);
+    a1 = lane(a1, _mm256_loadu_si256(in + 1), k1);
+  }
+  _mm256_storeu_si256(acc_ptr, a0);
+  _mm256_storeu_si256(acc_ptr + 1, a1);
+}
+
+inline void scramble_simd(uint64_t* acc) {
+  auto const acc_ptr = reinterpret_cast<__m256i*>(acc);
+  auto const prime = _mm256_set1_epi32(static_cast<int>(PRIME32_1));
+  for (auto i = 0; i != 2; ++i) {
+    auto a = _mm256_loadu_si256(acc_ptr + i);
+    a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+    a = _mm256_xor_si256(
+        a, _mm256_load_si256(reinterpret_cast<__m256i const*>(KEYS) + i));
+    auto const lo = _mm256_mul_epu32(a, prime);
+    auto const hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime);
+    _mm256_storeu_si256(acc_ptr + i,
+                        _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32)));
+  }
+}
+#elif defined(CISTA_WIDE_HASH_SSE2)
+inline void accumulate_simd(uint64_t* acc, uint8_t const* p,
+                            std::size_t const n_stripes) {
+  auto const acc_ptr = reinterpret_cast<__m128i*>(acc);
+  auto const key_ptr = reinterpret_cast<__m128i const*>(KEYS);
+  __m128i a[4], k[4];
+  for (auto i = 0; i != 4; ++i) {
+    a[i] = _mm_loadu_si128(acc_ptr + i);
+    k[i] = _mm_load_si128(key_ptr + i);
+  }
+  for (auto s = std::size_t{0U}; s != n_stripes; ++s, p += STRIPE_SIZE) {
+    auto const in = reinterpret_cast<__m128i const*>(p);
+    for (auto i = 0; i != 4; ++i) {
+      auto const d = _mm_loadu_si128(in + i);
+      auto const dk = _mm_xor_si128(d, k[i]);
+      auto const product = _mm_mul_epu32(dk, _mm_srli_epi64(dk, 32));
+      auto const swapped = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+      a[i] = _mm_add_epi64(a[i], _mm_add_epi64(product, swapped));
+    }
+  }
+  for (auto i = 0; i != 4; ++i) {
+    _mm_storeu_si128(acc_ptr + i, a[i]);
+  }
+}
+
+inline void scramble_simd(uint64_t* acc) {
+  auto const acc_ptr = reinterpret_cast<__m128i*>(acc);
+  auto const prime = _mm_set1_epi32(static_cast<int>(PRIME32_1));
+  for (auto i = 0; i != 4; ++i) {
+    auto a = _mm_loadu_si128(acc_ptr + i);
+    a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+    a = _mm_xor_si128(
+        a, _mm_load_si128(reinterpret_cast<__m128i const*>(KEYS) + i));
+    auto const lo = _mm_mul_epu32(a, prime);
+    auto const hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+    _mm_storeu_si128(acc_ptr + i, _mm_add_epi64(lo, _mm_slli_epi64(hi, 32)));
+  }
+}
+#else
+inline void accumulate_simd(uint64_t* acc, uint8_t const* p,
+                            std::size_t const n_stripes) {
+  accumulate_scalar(acc, p, n_stripes);
+}
+
+inline void scramble_simd(uint64_t* acc) { scramble_scalar(acc); }
+#endif
+
+// Lower 64bit xor upper 64bit of the 128bit product a * b.
+inline uint64_t mul128_fold64(uint64_t const a, uint64_t const b) {
+  auto const a_lo = a & uint64_t{0xFFFFFFFFU};
+  auto const a_hi = a >> 32U;
+  auto const b_lo = b & uint64_t{0xFFFFFFFFU};
+  auto const b_hi = b >> 32U;
+  auto const lo_lo = a_lo * b_lo;
+  auto const hi_lo = a_hi * b_lo;
+  auto const lo_hi = a_lo * b_hi;
+  auto const hi_hi = a_hi * b_hi;
+  auto const cross = (lo_lo >> 32U) + (hi_lo & 0xFFFFFFFFULL) + lo_hi;
+  auto const upper = (hi_lo >> 32U) + (cross >> 32U) + hi_hi;
+  auto const lower = (cross << 32U) | (lo_lo & 0xFFFFFFFFULL);
+  return lower ^ upper;
+}
+
+}  // namespace wide_hash_detail
+
+// Streaming interface: update() may be called with arbitrary chunk sizes,
+// the result only depends on the concatenated input.
+template <bool Vectorized = true>
+struct basic_wide_hasher {
+  basic_wide_hasher() = default;
+
+  void update(void const* data, std::size_t size) {
+    using namespace wide_hash_detail;
+
+    if (size == 0U) {
+      return;
+    }
+
+    auto p = static_cast<uint8_t const*>(data);
+    len_ += size;
+
+    if (buf_size_ != 0U) {
+      auto const n = std::min(size, STRIPE_SIZE - buf_size_);
+      std::memcpy(buf_ + buf_size_, p, n);
+      buf_size_ += n;
+      p += n;
+      size -= n;
+      if (buf_size_ != STRIPE_SIZE) {
+        return;
+      }
+      consume(buf_, 1U);
+      buf_size_ = 0U;
+    }
+
+    auto const n_stripes = size / STRIPE_SIZE;
+    consume(p, n_stripes);
+    p += n_stripes * STRIPE_SIZE;
+    size -= n_stripes * STRIPE_SIZE;
+
+    std::memcpy(buf_, p, size);
+    buf_size_ = size;
+  }
+
+  void update(std::string_view const s) { update(s.data(), s.size()); }
+
+  hash_t finish() const {
+    using namespace wide_hash_detail;
+
+    uint64_t acc[LANES];
+    std::memcpy(acc, acc_, sizeof(acc));
+    if (buf_size_ != 0U) {
+      uint8_t last[STRIPE_SIZE] = {0};
+      std::memcpy(last, buf_, buf_size_);
+      accumulate(acc, last, 1U);
+    }
+
+    auto h = static_cast<uint64_t>(len_) * PRIME64_1;
+    for (auto i = std::size_t{0U}; i != LANES; i += 2U) {
+      h += mul128_fold64(acc[i] ^ KEYS[i], acc[i + 1U] ^ PRIME64_2);
+    }
+    h ^= h >> 37U;
+    h *= PRIME64_3;
+    h ^= h >> 32U;
+    return h;
+  }
+
+private:
+  static void accumulate(uint64_t* acc, uint8_t const* p,
+                         std::size_t const n_stripes) {
+    if constexpr (Vectorized) {
+      wide_hash_detail::accumulate_simd(acc, p, n_stripes);
+    } else {
+      wide_hash_detail::accumulate_scalar(acc, p, n_stripes);
+    }
+  }
+
+  static void scramble(uint64_t* acc) {
+    if constexpr (Vectorized) {
+      wide_hash_detail::scramble_simd(acc);
+    } else {
+      wide_hash_detail::scramble_scalar(acc);
+    }
+  }
+
+  void consume(uint8_t const* p, std::size_t n_stripes) {
+    using namespace wide_hash_detail;
+    while (n_stripes != 0U) {
+      auto const n = std::min(n_stripes, STRIPES_PER_BLOCK - block_stripes_);
+      accumulate(acc_, p, n);
+      p += n * STRIPE_SIZE;
+      n_stripes -= n;
+      block_stripes_ += n;
+      if (block_stripes_ == STRIPES_PER_BLOCK) {
+        scramble(acc_);
+        block_stripes_ = 0U;
+      }
+    }
+  }
+
+  alignas(32) uint64_t acc_[wide_hash_detail::LANES] = {
+      wide_hash_detail::PRIME32_3, wide_hash_detail::PRIME64_1,
+      wide_hash_detail::PRIME64_2, wide_hash_detail::PRIME64_3,
+      wide_hash_detail::PRIME64_4, wide_hash_detail::PRIME32_2,
+      wide_hash_detail::PRIME64_5, wide_hash_detail::PRIME32_1};
+  uint8_t buf_[wide_hash_detail::STRIPE_SIZE] = {0};
+  std::size_t buf_size_{0U};
+  std::size_t block_stripes_{0U};
+  std::size_t len_{0U};
+};
+
+using wide_hasher = basic_wide_hasher<true>;
+
+template <bool Vectorized = true>
+inline hash_t wide_hash(std::string_view const s) {
+  auto h = basic_wide_hasher<Vectorized>{};
+  h.update(s);
+  return h.finish();
+}
+
+}  // namespace cista
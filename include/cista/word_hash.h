@@ -0,0 +1,247 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+#include "cista/endian/detection.h"
+#include "cista/hash.h"
+#include "cista/parallel_for.h"
+
+namespace cista {
+
+// Position dependent sum of 64bit words:
+//   sum = SUM_j mix(w_j) * P^j (mod 2^64), w_j = little endian word j
+// A partial last word is zero padded; the byte length is mixed into the
+// final value. As a sum, it can be updated in place when bytes are
+// overwritten: sum += contribution(new words) - contribution(old words).
+// This allows targets to maintain the checksum while writing (including
+// back-patched pointers) instead of re-reading the output at the end.
+namespace word_hash_detail {
+
+constexpr auto const WORD_SIZE = std::size_t{8U};
+constexpr auto const P = uint64_t{0x9E3779B97F4A7C15ULL};  // odd
+
+// Multiplicative inverse of P modulo 2^64 (Newton iteration).
+constexpr uint64_t inverse(uint64_t const p) {
+  auto x = p;
+  for (auto i = 0; i != 6; ++i) {
+    x *= 2U - p * x;
+  }
+  return x;
+}
+
+constexpr auto const P_INV = inverse(P);
+
+constexpr uint64_t pow(uint64_t base, std::size_t exp) {
+  auto result = uint64_t{1U};
+  while (exp != 0U) {
+    if ((exp & 1U) != 0U) {
+      result *= base;
+    }
+    base *= base;
+    exp >>= 1U;
+  }
+  return result;
+}
+
+// P^(b * 256^i) for every byte b of the exponent: pow_p(j) needs one
+// multiplication per non-zero byte of j instead of a square-and-multiply
+// loop (it is evaluated for every write).
+struct pow_table {
+  constexpr pow_table() : t_{} {
+    auto step = P;  // P^(256^i)
+    for (auto i = 0U; i != sizeof(std::size_t); ++i) {
+      auto x = uint64_t{1U};
+      for (auto b = 0U; b != 256U; ++b) {
+        t_[i][b] = x;
+        x *= step;
+      }
+      step = x;
+    }
+  }
+  uint64_t t_[sizeof(std::size_t)][256];
+};
+
+inline constexpr auto const POW_TABLE = pow_table{};
+
+inline uint64_t pow_p(std::size_t exp) {
+  auto result = uint64_t{1U};
+  for (auto i = 0U; exp != 0U; ++i, exp >>= 8U) {
+    result *= POW_TABLE.t_[i][exp & 0xFFU];
+  }
+  return result;
+}
+
+// Finalizer of MurmurHash3 (bijective, mix(0) = 0).
+inline uint64_t mix(uint64_t h) {
+  h ^= h >> 33U;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33U;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33U;
+  return h;
+}
+
+inline uint64_t read_word(uint8_t const* p, std::size_t const n) {
+  uint8_t bytes[WORD_SIZE] = {0};
+  std::memcpy(bytes, p, n);
+  auto w = uint64_t{0U};
+  for (auto i = 0U; i != WORD_SIZE; ++i) {
+    w |= static_cast<uint64_t>(bytes[i]) << (8U * i);
+  }
+  return w;
+}
+
+inline uint64_t read_word(uint8_t const* p) {
+  uint64_t w;
+  std::memcpy(&w, p, sizeof(w));
+#ifdef CISTA_BIG_ENDIAN
+  w = read_word(p, WORD_SIZE);
+#endif
+  return w;
+}
+
+}  // namespace word_hash_detail
+
+// Contribution of `size` bytes starting at word index first_word.
+inline uint64_t word_sum(uint8_t const* data, std::size_t const size,
+                         std::size_t const first_word) {
+  using namespace word_hash_detail;
+  auto sum = uint64_t{0U};
+  auto factor = pow_p(first_word);
+  auto const full_words = size / WORD_SIZE;
+  for (auto i = std::size_t{0U}; i != full_words; ++i) {
+    sum += mix(read_word(data + i * WORD_SIZE)) * factor;
+    factor *= P;
+  }
+  if (auto const rest = size % WORD_SIZE; rest != 0U) {
+    sum += mix(read_word(data + full_words * WORD_SIZE, rest)) * factor;
+  }
+  return sum;
+}
+
+// Contribution of the words overlapping [from, to[ of a buffer that holds
+// `size` bytes and starts at the absolute (word aligned) position base_pos.
+// Bytes beyond `size` count as zero.
+inline uint64_t word_sum_range(uint8_t const* base, std::size_t const base_pos,
+                               std::size_t const size, std::size_t from,
+                               std::size_t to) {
+  using namespace word_hash_detail;
+  from -= from % WORD_SIZE;
+  to = std::min(size, (to + WORD_SIZE - 1U) / WORD_SIZE * WORD_SIZE);
+  if (to <= from) {
+    return 0U;
+  }
+  return word_sum(base + from, to - from, (base_pos + from) / WORD_SIZE);
+}
+
+// Overwrites [from, from + n[ of a buffer that holds `size` bytes (with
+// from + n <= size) and starts at the absolute (word aligned) position
+// base_pos. Returns the change of the word sum.
+inline uint64_t word_sum_write(uint8_t* base, std::size_t const base_pos,
+                               std::size_t const size, std::size_t const from,
+                               void const* src, std::size_t const n) {
+  using namespace word_hash_detail;
+  auto const first = from - from % WORD_SIZE;
+  if (from + n > first + 2U * WORD_SIZE) {
+    auto const before = word_sum_range(base, base_pos, size, from, from + n);
+    std::memcpy(base + from, src, n);
+    return word_sum_range(base, base_pos, size, from, from + n) - before;
+  }
+
+  // Small write (pointer patch): at most two words, one pow_p.
+  auto const words = std::min(size - first, 2U * WORD_SIZE);
+  auto const read = [&](std::size_t const offset) {
+    return offset >= words ? uint64_t{0U}
+           : offset + WORD_SIZE > words
+               ? read_word(base + first + offset, words - offset)
+               : read_word(base + first + offset);
+  };
+  auto const old0 = read(0U), old1 = read(WORD_SIZE);
+  std::memcpy(base + from, src, n);
+  auto const factor = pow_p((base_pos + first) / WORD_SIZE);
+  return ((mix(read(0U)) - mix(old0)) +
+          (mix(read(WORD_SIZE)) - mix(old1)) * P) *
+         factor;
+}
+
+// Checksum of `length` bytes starting at word index first_word with the
+// given (absolute) word sum.
+inline hash_t word_hash_finish(uint64_t const sum, std::size_t const first_word,
+                               std::size_t const length) {
+  using namespace word_hash_detail;
+  auto const relative = sum * pow(P_INV, first_word);
+  return mix(relative ^ mix(static_cast<uint64_t>(length) ^ P));
+}
+
+inline hash_t word_hash(std::string_view const s,
+                        unsigned const parallelism = 1U) {
+  constexpr auto const CHUNK_SIZE = std::size_t{1U} << 20U;
+  auto const data = reinterpret_cast<uint8_t const*>(s.data());
+  auto const n_chunks = (s.size() + CHUNK_SIZE - 1U) / CHUNK_SIZE;
+
+  auto sums = std::vector<uint64_t>(n_chunks);
+  parallel_for(parallelism, n_chunks,
+               [&](std::size_t const from, std::size_t const to) {
+                 for (auto i = from; i != to; ++i) {
+                   auto const offset = i * CHUNK_SIZE;
+                   sums[i] = word_sum(data + offset,
+                                      std::min(CHUNK_SIZE, s.size() - offset),
+                                      offset / word_hash_detail::WORD_SIZE);
+                 }
+               });
+
+  auto sum = uint64_t{0U};
+  for (auto const x : sums) {
+    sum += x;
+  }
+  return word_hash_finish(sum, 0U, s.size());
+}
+
+// Streaming interface (for targets without incremental checksum support).
+struct word_hasher {
+  void update(void const* data, std::size_t size) {
+    using namespace word_hash_detail;
+
+    auto p = static_cast<uint8_t const*>(data);
+    if (buf_size_ != 0U) {
+      auto const n = std::min(size, WORD_SIZE - buf_size_);
+      std::memcpy(buf_ + buf_size_, p, n);
+      buf_size_ += n;
+      p += n;
+      size -= n;
+      if (buf_size_ != WORD_SIZE) {
+        return;
+      }
+      sum_ += word_sum(buf_, WORD_SIZE, length_ / WORD_SIZE);
+      length_ += WORD_SIZE;
+      buf_size_ = 0U;
+    }
+
+    auto const full = size - size % WORD_SIZE;
+    sum_ += word_sum(p, full, length_ / WORD_SIZE);
+    length_ += full;
+
+    std::memcpy(buf_, p + full, size - full);
+    buf_size_ = size - full;
+  }
+
+  void update(std::string_view const s) { update(s.data(), s.size()); }
+
+  hash_t finish() const {
+    using namespace word_hash_detail;
+    auto const sum = sum_ + word_sum(buf_, buf_size_, length_ / WORD_SIZE);
+    return word_hash_finish(sum, 0U, length_ + buf_size_);
+  }
+
+private:
+  uint64_t sum_{0U};
+  std::size_t length_{0U};  // bytes in sum_ (multiple of WORD_SIZE)
+  uint8_t buf_[word_hash_detail::WORD_SIZE] = {0};
+  std::size_t buf_size_{0U};
+};
+
+}  // namespace cista
@@ -0,0 +1,103 @@
+#include <string>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#include "cista/targets/buffered_file.h"
+#endif
+
+#include "graph_fixture.h"
+
+namespace block_checksum_test {
+
+using graph = graph_fixture::graph<graph_fixture::offset>;
+
+}  // namespace block_checksum_test
+
+using namespace block_checksum_test;
+
+TEST_CASE("block checksum streaming") {
+  auto const s = std::string(3U * cista::BLOCK_CHECKSUM_SIZE + 17U, 'x');
+  auto h = cista::block_hasher<cista::wide_hasher>{s.size() - 1U};
+  for (auto i = std::size_t{0U}; i < s.size(); i += 1000U) {
+    h.update(std::string_view{s}.substr(i, 1000U));
+  }
+  auto const hashes = h.finish();
+  REQUIRE(hashes.size() == 4U);
+  CHECK(hashes[0] == cista::block_checksum<cista::wide_hasher>(
+                         std::string_view{s}.substr(0U, 4096U)));
+  CHECK(hashes[3] == cista::block_checksum<cista::wide_hasher>(
+                         std::string_view{s}.substr(3U * 4096U, 16U)));
+}
+
+TEST_CASE("block checksum lazy verification") {
+  constexpr auto const FILENAME = "block_checksum_test.bin";
+  constexpr auto const MODE = cista::mode::WITH_VERSION |
+                              cista::mode::WITH_INTEGRITY |
+                              cista::mode::BLOCK_CHECKSUMS;
+
+  auto g = graph_fixture::make_graph<graph_fixture::offset>(100U);
+  auto b = cista::serialize<MODE>(g);
+  CHECK(cista::serialized_size_of<MODE>(g) == b.size());
+  {
+    cista::buffered_file f{FILENAME, 4096U};
+    cista::serialize<MODE>(f, g);
+  }
+  auto const from_file = cista::file(FILENAME, "r").content();
+  REQUIRE(from_file.size() == b.size());
+  CHECK(std::memcmp(from_file.data(), b.data(), b.size()) == 0);
+
+  // Corrupt the payload of the last node with a large payload.
+  auto const last = 98U;
+  REQUIRE(graph_fixture::payload_size(last) > 100U);
+  {
+    auto const deserialized = cista::deserialize<graph, MODE>(b);
+    auto& payload = deserialized->nodes_[last]->payload_;
+    payload[100] ^= 1U;
+  }
+
+  auto v = cista::block_verifier<MODE>{b.data(), b.data() + b.size()};
+  REQUIRE(v.n_blocks() > 10U);
+  auto const root = v.root<graph>();
+  CHECK(v.is_verified(0U));
+  CHECK(!v.is_verified(v.n_blocks() - 1U));
+
+  auto const& nodes = root->nodes_;
+  v.verify_range(&nodes[0], nodes.size() * sizeof(nodes[0]));
+  auto const first = v.verified(nodes[0].get());
+  v.verify_range(&first->payload_[0],
+                 first->payload_.size() * sizeof(uint64_t));
+  CHECK(first->payload_[199] == 0U);
+
+  auto const middle = v.verified(nodes[last / 2U].get());
+  v.verify_range(&middle->payload_[0],
+                 middle->payload_.size() * sizeof(uint64_t));
+
+  auto const corrupted = nodes[last].get();
+  CHECK_THROWS(v.verify_range(&corrupted->payload_[100], sizeof(uint64_t)));
+  CHECK_THROWS(v.verify_all());
+  CHECK_THROWS(v.verify_range(b.data(), 1U));
+  CHECK_THROWS((cista::deserialize<graph, MODE>(b)));
+}
+
+TEST_CASE("block checksum raw mode") {
+  namespace raw = cista::raw;
+  constexpr auto const MODE =
+      cista::mode::WITH_RELOCATIONS | cista::mode::BLOCK_CHECKSUMS;
+
+  raw::vector<raw::string> v;
+  for (auto i = 0U; i != 1000U; ++i) {
+    v.emplace_back().set_owning("A STRING LONGER THAN FIFTEEN CHARS " +
+                                std::to_string(i));
+  }
+  auto b = cista::serialize<MODE>(v);
+  auto b1 = cista::serialize<MODE>(v);
+  CHECK((*cista::deserialize<raw::vector<raw::string>, MODE>(b))[999] ==
+        v[999]);
+
+  b1[b1.size() / 2U] ^= 1U;
+  CHECK_THROWS((cista::deserialize<raw::vector<raw::string>, MODE>(b1)));
+}
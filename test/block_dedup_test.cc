@@ -0,0 +1,143 @@
+#include <cinttypes>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#endif
+
+namespace {
+
+struct payload {
+  uint64_t a_, b_;
+};
+
+// Generic serialize(), custom in place deserialize().
+struct doubled {
+  uint32_t value_;
+};
+
+template <typename Ctx>
+void deserialize(Ctx const&, doubled* el) {
+  el->value_ *= 2U;
+}
+
+template <typename Ptr>
+uintptr_t address(Ptr const& p) {
+  return reinterpret_cast<uintptr_t>(static_cast<void const*>(&*p));
+}
+
+}  // namespace
+
+TEST_CASE("block deduplication raw") {
+  namespace data = cista::raw;
+  constexpr auto const MODE = cista::mode::DEDUPLICATE_BLOCKS;
+
+  struct trip {
+    data::vector<uint32_t> stops_;
+    data::unique_ptr<payload> payload_;
+    payload* ref_;
+  };
+  using trips_t = data::vector<trip>;
+
+  trips_t trips;
+  for (auto i = 0U; i != 100U; ++i) {
+    auto& t = trips.emplace_back();
+    for (auto j = 0U; j != 10U; ++j) {
+      t.stops_.push_back(j * (i % 2U));
+    }
+    t.payload_ = data::make_unique<payload>(payload{i % 4U, 7U});
+    t.ref_ = t.payload_.get();
+  }
+
+  cista::buf<cista::byte_buf> plain, dedup;
+  auto const plain_stats = cista::serialize(plain, trips);
+  auto const stats = cista::serialize<MODE>(dedup, trips);
+
+  CHECK(plain_stats.deduplicated_blocks_ == 0U);
+  CHECK(stats.deduplicated_blocks_ == 98U + 96U);
+  CHECK(stats.deduplicated_bytes_ == 98U * 40U + 96U * sizeof(payload));
+  CHECK(dedup.buf_.size() + stats.deduplicated_bytes_ == plain.buf_.size());
+  CHECK(cista::serialized_size_of<MODE>(trips) == dedup.buf_.size());
+
+  auto const d = cista::deserialize<trips_t, MODE>(dedup.buf_);
+  REQUIRE(d->size() == 100U);
+  for (auto i = 0U; i != 100U; ++i) {
+    auto const& t = (*d)[i];
+    REQUIRE(t.stops_.size() == 10U);
+    CHECK(t.stops_[9] == 9U * (i % 2U));
+    CHECK(t.payload_->a_ == i % 4U);
+    CHECK(t.payload_->b_ == 7U);
+    CHECK(t.ref_ == t.payload_.get());
+  }
+  CHECK(address((*d)[0].stops_.begin()) == address((*d)[2].stops_.begin()));
+  CHECK(address((*d)[0].payload_) == address((*d)[4].payload_));
+  CHECK(address((*d)[0].payload_) != address((*d)[1].payload_));
+}
+
+TEST_CASE("block deduplication offset respects alignment") {
+  namespace data = cista::offset;
+  constexpr auto const MODE = cista::mode::DEDUPLICATE_BLOCKS |
+                              cista::mode::DEDUPLICATE_STRINGS |
+                              cista::mode::WITH_VERSION |
+                              cista::mode::WITH_INTEGRITY;
+
+  struct x {
+    data::vector<uint8_t> pad_;
+    data::vector<uint8_t> bytes_;
+    data::vector<uint32_t> ints_;
+    data::vector<uint32_t> same_ints_;
+  };
+
+  x value;
+  value.pad_.push_back(9U);
+  for (auto const b : {1U, 0U, 0U, 0U}) {
+    value.bytes_.push_back(static_cast<uint8_t>(b));
+  }
+  value.ints_.push_back(1U);
+  value.same_ints_.push_back(1U);
+
+  cista::buf<cista::byte_buf> out;
+  auto const stats = cista::serialize<MODE>(out, value);
+  CHECK(stats.deduplicated_blocks_ == 1U);
+  CHECK(stats.deduplicated_bytes_ == 4U);
+
+  auto const d = cista::deserialize<x, MODE>(out.buf_);
+  CHECK(d->bytes_.size() == 4U);
+  CHECK(d->ints_[0] == 1U);
+  CHECK(d->same_ints_[0] == 1U);
+  CHECK(address(d->ints_.begin()) % alignof(uint32_t) == 0U);
+  CHECK(address(d->ints_.begin()) == address(d->same_ints_.begin()));
+  CHECK(address(d->ints_.begin()) != address(d->bytes_.begin()));
+}
+
+TEST_CASE("block deduplication skips custom deserialize functions") {
+  namespace data = cista::offset;
+  constexpr auto const MODE = cista::mode::DEDUPLICATE_BLOCKS;
+
+  struct x {
+    data::vector<doubled> a_;
+    data::vector<doubled> b_;
+    data::unique_ptr<doubled> c_;
+    data::unique_ptr<doubled> d_;
+  };
+
+  x value;
+  value.a_.push_back(doubled{21U});
+  value.b_.push_back(doubled{21U});
+  value.c_ = data::make_unique<doubled>(doubled{21U});
+  value.d_ = data::make_unique<doubled>(doubled{21U});
+
+  cista::buf<cista::byte_buf> out;
+  auto const stats = cista::serialize<MODE>(out, value);
+  CHECK(stats.deduplicated_blocks_ == 0U);
+
+  auto const d = cista::deserialize<x, MODE>(out.buf_);
+  CHECK(d->a_[0].value_ == 42U);
+  CHECK(d->b_[0].value_ == 42U);
+  CHECK(d->c_->value_ == 42U);
+  CHECK(d->d_->value_ == 42U);
+  CHECK(address(d->a_.begin()) != address(d->b_.begin()));
+}
@@ -0,0 +1,57 @@
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/buffer.h"
+#include "cista/hash.h"
+#include "cista/serialization.h"
+#endif
+
+TEST_CASE("buffer grows geometrically and keeps content") {
+  cista::buffer b;
+  CHECK(b.size() == 0U);
+  CHECK(b.capacity() == 0U);
+
+  for (auto i = 0U; i != 1000U; ++i) {
+    b.resize(b.size() + 1U);
+    b[i] = static_cast<unsigned char>(i);
+  }
+  CHECK(b.size() == 1000U);
+  CHECK(b.capacity() >= 1000U);
+  CHECK(b.capacity() < 2048U);
+  for (auto i = 0U; i != 1000U; ++i) {
+    CHECK(b[i] == static_cast<unsigned char>(i));
+  }
+
+  auto const data = b.data();
+  b.resize(10U);
+  CHECK(b.size() == 10U);
+  CHECK(b.data() == data);
+}
+
+TEST_CASE("buffer reserve") {
+  cista::buffer b;
+  b.reserve(100U);
+  CHECK(b.size() == 0U);
+  CHECK(b.capacity() == 100U);
+
+  auto const data = b.data();
+  b.resize(100U);
+  CHECK(b.data() == data);
+
+  cista::buffer moved;
+  moved = std::move(b);
+  CHECK(moved.size() == 100U);
+  CHECK(moved.capacity() == 100U);
+  CHECK(b.size() == 0U);
+  CHECK(b.capacity() == 0U);
+}
+
+TEST_CASE("empty buffer") {
+  cista::byte_buf b;
+  CHECK_THROWS(cista::deserialize<int>(b));
+  CHECK_THROWS(cista::unchecked_deserialize<int>(b));
+  CHECK_THROWS((cista::deserialize<int, cista::mode::WITH_VERSION>(b)));
+  CHECK(cista::hash(b) == cista::hash(std::string_view{}));
+}
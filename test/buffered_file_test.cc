@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <string>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#include "cista/targets/buffered_file.h"
+#endif
+
+#include "graph_fixture.h"
+
+namespace buffered_file_test {
+
+using graph = graph_fixture::graph<graph_fixture::offset>;
+
+}  // namespace buffered_file_test
+
+using namespace buffered_file_test;
+
+TEST_CASE("buffered file matches buf") {
+  constexpr auto const FILENAME = "buffered_file_test.bin";
+  constexpr auto const MODE =
+      cista::mode::WITH_VERSION | cista::mode::WITH_INTEGRITY;
+
+  auto g = graph_fixture::make_graph<graph_fixture::offset>(500U);
+  auto const expected = cista::serialize<MODE>(g);
+
+  // Buffer much smaller than the output: most pointer patches hit
+  // data that has already been written to the file.
+  {
+    cista::buffered_file f{FILENAME, 4096U};
+    cista::serialize<MODE>(f, g);
+    CHECK(f.size() == expected.size());
+  }
+
+  auto b = cista::file(FILENAME, "r").content();
+  REQUIRE(b.size() == expected.size());
+  CHECK(std::memcmp(b.data(), expected.data(), b.size()) == 0);
+
+  graph_fixture::check_graph(cista::deserialize<graph, MODE>(b), 500U);
+}
+
+TEST_CASE("buffered file patches") {
+  constexpr auto const FILENAME = "buffered_file_patch_test.bin";
+
+  auto const zeros = std::vector<uint8_t>(10000U, 0U);
+  {
+    cista::buffered_file f{FILENAME, 4096U};
+    CHECK(f.write(zeros.data(), zeros.size(), 0U) == 0);
+    f.write(8U, uint64_t{1U});
+    f.write(16U, uint64_t{2U});
+    f.write(std::size_t{0U}, uint64_t{3U});
+    f.write(8U, uint64_t{4U});
+    CHECK(f.write(zeros.data(), 3U, 0U) == 10000);
+    CHECK(f.write(zeros.data(), 8U, 8U) == 10008);
+    f.write(10008U, uint64_t{5U});
+    f.write(9992U, uint64_t{6U});
+    f.write(20U, uint64_t{7U});
+    f.write(16U, uint64_t{8U});
+  }
+
+  auto b = cista::file(FILENAME, "r").content();
+  REQUIRE(b.size() == 10016U);
+  auto const at = [&](std::size_t const pos) {
+    auto val = uint64_t{0U};
+    std::memcpy(&val, b.data() + pos, sizeof(val));
+    return val;
+  };
+  CHECK(at(0U) == 3U);
+  CHECK(at(8U) == 4U);
+  CHECK(at(16U) == 8U);
+  CHECK(at(24U) == 0U);
+  CHECK(at(9992U) == 6U);
+  CHECK(at(10000U) == 0U);
+  CHECK(at(10008U) == 5U);
+}
+
+#ifdef __linux__
+TEST_CASE("buffered file reports write errors on flush only") {
+  auto const data = std::string(100U, 'x');
+  {
+    cista::buffered_file f{"/dev/full"};
+    f.write(data.data(), data.size(), 0U);
+    CHECK_THROWS(f.flush());
+  }
+  CHECK_NOTHROW(([&]() {
+    cista::buffered_file f{"/dev/full"};
+    f.write(data.data(), data.size(), 0U);
+  }()));
+}
+#endif
+
+TEST_CASE("buffered file move assignment flushes") {
+  constexpr auto const FILENAME_A = "buffered_file_move_a.bin";
+  constexpr auto const FILENAME_B = "buffered_file_move_b.bin";
+
+  auto const a = std::string(10000U, 'a');
+  auto const b = std::string(100U, 'b');
+  {
+    cista::buffered_file f{FILENAME_A, 4096U};
+    f.write(a.data(), a.size());
+    f.write(std::size_t{0U}, uint64_t{0U});  // recorded patch
+    f = cista::buffered_file{FILENAME_B, 4096U};
+    f.write(b.data(), b.size());
+  }
+
+  auto const content_a = cista::file(FILENAME_A, "r").content();
+  REQUIRE(content_a.size() == a.size());
+  CHECK(std::all_of(content_a.begin() + 8, content_a.end(),
+                    [](auto const c) { return c == 'a'; }));
+  CHECK(std::all_of(content_a.begin(), content_a.begin() + 8,
+                    [](auto const c) { return c == 0U; }));
+  CHECK(cista::file(FILENAME_B, "r").content().size() == b.size());
+}
@@ -0,0 +1,84 @@
+#include <random>
+#include <vector>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/chunked_hash.h"
+#include "cista/serialization.h"
+#include "cista/wide_hash.h"
+#endif
+
+namespace chunked_checksum_test {
+
+inline std::vector<char> random_bytes(std::size_t const n) {
+  auto rng = std::mt19937{static_cast<unsigned>(n)};
+  auto dist = std::uniform_int_distribution<int>{0, 255};
+  auto v = std::vector<char>(n);
+  for (auto& c : v) {
+    c = static_cast<char>(dist(rng));
+  }
+  return v;
+}
+
+template <typename Hasher>
+cista::hash_t streamed(std::string_view const s, std::size_t const step) {
+  auto h = cista::chunked_hasher<Hasher>{};
+  for (auto i = std::size_t{0U}; i < s.size(); i += step) {
+    h.update(s.substr(i, step));
+  }
+  return h.finish();
+}
+
+}  // namespace chunked_checksum_test
+
+using namespace chunked_checksum_test;
+
+TEST_CASE("chunked checksum parallel equals streaming") {
+  constexpr auto const CHUNK = cista::CHECKSUM_CHUNK_SIZE;
+  for (auto const n : {std::size_t{0U}, std::size_t{1U}, CHUNK - 1U, CHUNK,
+                       CHUNK + 1U, 3U * CHUNK + 12345U}) {
+    auto const data = random_bytes(n);
+    auto const s = std::string_view{data.data(), data.size()};
+
+    auto const serial = cista::chunked_checksum<cista::wide_hasher>(s, 1U);
+    CHECK(cista::chunked_checksum<cista::wide_hasher>(s, 4U) == serial);
+    CHECK(streamed<cista::wide_hasher>(s, 4096U) == serial);
+    CHECK(streamed<cista::wide_hasher>(s, 100003U) == serial);
+
+    CHECK(cista::chunked_checksum<cista::fnv1a_hasher>(s, 3U) ==
+          streamed<cista::fnv1a_hasher>(s, 65536U));
+  }
+}
+
+TEST_CASE("chunked checksum mode") {
+  namespace data = cista::offset;
+  constexpr auto const MODE = cista::mode::WITH_INTEGRITY |
+                              cista::mode::WIDE_CHECKSUM |
+                              cista::mode::CHUNKED_CHECKSUM;
+  constexpr auto const FILENAME = "chunked_checksum_test.bin";
+
+  data::vector<uint64_t> v;
+  for (auto i = 0U; i != 500000U; ++i) {
+    v.emplace_back(i);
+  }
+
+  auto buf = cista::serialize<MODE>(v);
+  REQUIRE(buf.size() > 3U * cista::CHECKSUM_CHUNK_SIZE);
+  {
+    cista::file f{FILENAME, "w+"};
+    cista::serialize<MODE>(f, v);
+  }
+  auto const from_file = cista::file(FILENAME, "r").content();
+  REQUIRE(from_file.size() == buf.size());
+  CHECK(std::memcmp(from_file.data(), buf.data(), buf.size()) == 0);
+
+  CHECK((*cista::deserialize<data::vector<uint64_t>, MODE>(buf, 4U))[499999] ==
+        499999U);
+
+  buf[buf.size() / 2U] ^= 1U;
+  CHECK_THROWS((cista::deserialize<data::vector<uint64_t>, MODE>(buf, 4U)));
+  CHECK_THROWS((cista::deserialize<data::vector<uint64_t>, MODE>(buf)));
+}
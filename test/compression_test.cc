@@ -0,0 +1,196 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/compression.h"
+#include "cista/serialization.h"
+#endif
+
+namespace {
+
+std::vector<uint8_t> lz_roundtrip(std::vector<uint8_t> const& in) {
+  auto compressed = std::vector<uint8_t>(cista::lz_compress_bound(in.size()));
+  compressed.resize(
+      cista::lz_compress(in.data(), in.size(), compressed.data()));
+  auto out = std::vector<uint8_t>(in.size());
+  cista::lz_decompress(compressed.data(), compressed.size(), out.data(),
+                       out.size());
+  return out;
+}
+
+}  // namespace
+
+TEST_CASE("lz roundtrip") {
+  auto gen = std::mt19937{7U};
+  auto byte = std::uniform_int_distribution<unsigned>{0U, 255U};
+
+  auto random = std::vector<uint8_t>(100000U);
+  for (auto& b : random) {
+    b = static_cast<uint8_t>(byte(gen));
+  }
+
+  auto text = std::vector<uint8_t>{};
+  while (text.size() < 100000U) {
+    auto const word = "token" + std::to_string(byte(gen) % 50U) + " ";
+    text.insert(end(text), begin(word), end(word));
+  }
+
+  for (auto const& in :
+       {std::vector<uint8_t>{}, std::vector<uint8_t>{1U, 2U, 3U},
+        std::vector<uint8_t>(70000U, uint8_t{'a'}), random, text}) {
+    CHECK(lz_roundtrip(in) == in);
+  }
+
+  auto compressed = std::vector<uint8_t>(cista::lz_compress_bound(text.size()));
+  CHECK(cista::lz_compress(text.data(), text.size(), compressed.data()) <
+        text.size() / 2U);
+}
+
+TEST_CASE("lz decompress corrupt input") {
+  auto out = std::vector<uint8_t>(16U);
+  auto const decompress = [&](std::vector<uint8_t> const& in) {
+    cista::lz_decompress(in.data(), in.size(), out.data(), out.size());
+  };
+
+  CHECK_THROWS(decompress({}));
+  CHECK_THROWS(decompress({0xF0U}));  // truncated literal length
+  CHECK_THROWS(decompress({0x40U, 'a', 'b'}));  // truncated literals
+  CHECK_THROWS(decompress({0x10U, 'a', 2U, 0U}));  // distance too large
+  CHECK_THROWS(decompress({0x10U, 'a', 0U, 0U}));  // distance 0
+  CHECK_THROWS(decompress({0x1FU, 'a', 1U, 0U, 200U}));  // match too long
+  CHECK_THROWS(decompress({0x10U, 'a'}));  // output too short
+  CHECK_NOTHROW(decompress({0x1AU, 'a', 1U, 0U, 0x10U, 'b'}));
+  CHECK(out[14] == 'a');
+  CHECK(out[15] == 'b');
+}
+
+TEST_CASE("compressed serialized data") {
+  namespace data = cista::offset;
+  using map_t = data::hash_map<uint32_t, data::string>;
+  constexpr auto const MODE =
+      cista::mode::WITH_VERSION | cista::mode::WITH_INTEGRITY;
+
+  auto m = map_t{};
+  for (auto i = 0U; i != 20000U; ++i) {
+    auto const s = "value number " + std::to_string(i);
+    m.emplace(i, data::string{s.c_str(), data::string::owning});
+  }
+  auto const serialized = cista::serialize<MODE>(m);
+  auto const compressed = cista::compress(serialized, 4096U, 4U);
+  CHECK(compressed.size() < serialized.size() / 2U);
+
+  auto const view =
+      cista::compressed_view{compressed.data(), compressed.size()};
+  CHECK(view.size() == serialized.size());
+  CHECK(view.block_count() == (serialized.size() + 4095U) / 4096U);
+
+  for (auto const parallelism : {1U, 3U}) {
+    auto buf = view.decompress(parallelism);
+    REQUIRE(buf.size() == serialized.size());
+    CHECK(std::equal(buf.begin(), buf.end(), serialized.begin()));
+    auto const d = cista::deserialize<map_t, MODE>(buf);
+    CHECK(d->size() == 20000U);
+    CHECK(d->at(12345U) == "value number 12345");
+  }
+}
+
+TEST_CASE("compressed block cache") {
+  auto gen = std::mt19937{3U};
+  auto dist = std::uniform_int_distribution<unsigned>{0U, 15U};
+  auto data = std::vector<uint8_t>(10500U);
+  for (auto& b : data) {
+    b = static_cast<uint8_t>(dist(gen));
+  }
+
+  auto const compressed = cista::compress(data, 1000U);
+  auto const view =
+      cista::compressed_view{compressed.data(), compressed.size()};
+  CHECK(view.block_count() == 11U);
+  CHECK(view.uncompressed_block_size(10U) == 500U);
+
+  auto cache = cista::block_cache{view, 2U};
+  CHECK(cache.block(10U).size() == 500U);
+  CHECK(cache.block(10U).size() == 500U);
+  CHECK(cache.hits_ == 1U);
+  CHECK(cache.misses_ == 1U);
+  CHECK_THROWS(cache.block(11U));
+
+  auto out = std::vector<uint8_t>(2500U);
+  cache.read(900U, out.data(), out.size());
+  CHECK(std::equal(begin(out), end(out), begin(data) + 900));
+  CHECK(cache.misses_ == 5U);
+
+  cache.read(3300U, out.data(), 100U);  // block 3 still cached
+  CHECK(cache.misses_ == 5U);
+  cache.read(1100U, out.data(), 100U);  // block 1 evicted
+  CHECK(cache.misses_ == 6U);
+  CHECK(std::equal(begin(out), begin(out) + 100, begin(data) + 1100));
+
+  cache.read(0U, out.data(), 0U);
+  cache.read(10500U, out.data(), 0U);
+  CHECK_THROWS(cache.read(10400U, out.data(), 101U));
+}
+
+TEST_CASE("compressed view rejects corrupt container") {
+  auto const data = std::vector<uint8_t>(5000U, uint8_t{7U});
+  auto const compressed = cista::compress(data, 1000U);
+
+  auto const check_corrupt = [&](std::size_t const offset,
+                                 uint8_t const value) {
+    auto copy = std::vector<uint8_t>(compressed.begin(), compressed.end());
+    copy[offset] = value;
+    CHECK_THROWS(
+        (cista::compressed_view{copy.data(), copy.size()}.decompress()));
+  };
+
+  CHECK_THROWS((cista::compressed_view{compressed.data(), 16U}));
+  CHECK_THROWS((cista::compressed_view{compressed.data(), 40U}));
+  check_corrupt(0U, 0U);  // magic
+  check_corrupt(8U, 0U);  // block size
+  check_corrupt(24U, 9U);  // block count
+  check_corrupt(32U, 0xFFU);  // first block end
+  check_corrupt(32U + 5U * 8U, 0x80U);  // block data
+
+  auto const empty = cista::compress(data.data(), 0U);
+  auto const empty_view = cista::compressed_view{empty.data(), empty.size()};
+  CHECK(empty_view.decompress().size() == 0U);
+}
+
+TEST_CASE("compressed view rejects forged sizes") {
+  auto const forge = [](uint64_t const block_size, uint64_t const size,
+                        uint64_t const block_end) {
+    auto out = std::vector<uint8_t>(41U);
+    auto const fields = {cista::COMPRESSION_MAGIC, block_size, size,
+                         uint64_t{1U}, block_end};
+    auto p = out.data();
+    for (auto const v : fields) {
+      for (auto i = 0U; i != 8U; ++i) {
+        *p++ = static_cast<uint8_t>(v >> (8U * i));
+      }
+    }
+    return out;
+  };
+
+  auto const ok = forge(4U, 1U, 1U);
+  CHECK((cista::compressed_view{ok.data(), ok.size()}.size() == 1U));
+
+  auto const huge = forge(uint64_t{1U} << 60U, uint64_t{1U} << 60U, 1U);
+  CHECK_THROWS((cista::compressed_view{huge.data(), huge.size()}));
+
+  auto const large = forge(uint64_t{1U} << 32U, uint64_t{1U} << 30U, 1U);
+  CHECK_THROWS((cista::compressed_view{large.data(), large.size()}));
+
+  // Frames are sized by the largest block, not the nominal block size.
+  auto const data = std::vector<uint8_t>(100U, uint8_t{1U});
+  auto const compressed = cista::compress(data, std::size_t{1U} << 30U);
+  auto const view =
+      cista::compressed_view{compressed.data(), compressed.size()};
+  auto cache = cista::block_cache{view, 1000U};
+  CHECK(cache.block(0U) ==
+        std::string_view{reinterpret_cast<char const*>(data.data()), 100U});
+}
@@ -33,7 +33,7 @@ struct version_detection {
 
 TEST_CASE("downward compatibility test") {
   for (auto const i : {1, 2}) {
-    std::vector<uint8_t> buf;
+    cista::byte_buf buf;
     switch (i) {
       case 1: {
         data_v1 values;
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/containers.h"
+#endif
+
+// Node / edge graph shared by the serialization tests, for raw pointers
+// (graph<raw>) and offset pointers (graph<offset>). Node i has an edge to
+// node (i + 1) % n, every 7th node has a large payload.
+namespace graph_fixture {
+
+struct raw {
+  template <typename T>
+  using ptr = cista::raw::ptr<T>;
+
+  template <typename T>
+  using vector = cista::raw::vector<T>;
+
+  template <typename T>
+  using unique_ptr = cista::raw::unique_ptr<T>;
+
+  using string = cista::raw::string;
+
+  template <typename T, typename... Args>
+  static unique_ptr<T> make_unique(Args&&... args) {
+    return cista::raw::make_unique<T>(std::forward<Args>(args)...);
+  }
+};
+
+struct offset {
+  template <typename T>
+  using ptr = cista::offset::ptr<T>;
+
+  template <typename T>
+  using vector = cista::offset::vector<T>;
+
+  template <typename T>
+  using unique_ptr = cista::offset::unique_ptr<T>;
+
+  using string = cista::offset::string;
+
+  template <typename T, typename... Args>
+  static unique_ptr<T> make_unique(Args&&... args) {
+    return cista::offset::make_unique<T>(std::forward<Args>(args)...);
+  }
+};
+
+template <typename Data>
+struct node;
+
+template <typename Data>
+struct edge {
+  typename Data::template ptr<node<Data>> from_;
+  typename Data::template ptr<node<Data>> to_;
+};
+
+template <typename Data>
+struct node {
+  uint32_t id_{0};
+  typename Data::template vector<typename Data::template ptr<edge<Data>>>
+      edges_;
+  typename Data::string name_;
+  typename Data::template vector<uint64_t> payload_;
+};
+
+template <typename Data>
+struct graph {
+  template <typename T>
+  using unique_ptrs =
+      typename Data::template vector<typename Data::template unique_ptr<T>>;
+
+  unique_ptrs<node<Data>> nodes_;
+  unique_ptrs<edge<Data>> edges_;
+  typename Data::template ptr<node<Data>> entry_{nullptr};
+  typename Data::template ptr<node<Data>> null_{nullptr};
+};
+
+inline std::string node_name(unsigned const i) {
+  return "NODE NAME LONGER THAN 15 CHARS " + std::to_string(i);
+}
+
+inline unsigned payload_size(unsigned const i) {
+  return i % 7U == 0U ? 1000U : 3U;
+}
+
+template <typename Data>
+graph<Data> make_graph(unsigned const n) {
+  graph<Data> g;
+  for (auto i = 0U; i < n; ++i) {
+    auto& nd = g.nodes_.emplace_back(Data::template make_unique<node<Data>>());
+    nd->id_ = i;
+    nd->name_.set_owning(node_name(i));
+    for (auto j = 0U; j != payload_size(i); ++j) {
+      nd->payload_.emplace_back(uint64_t{i} * j);
+    }
+  }
+  for (auto i = 0U; i < n; ++i) {
+    auto const from = g.nodes_[i].get();
+    auto const to = g.nodes_[(i + 1U) % n].get();
+    auto const e = g.edges_
+                       .emplace_back(Data::template make_unique<edge<Data>>(
+                           edge<Data>{from, to}))
+                       .get();
+    from->edges_.emplace_back(e);
+  }
+  g.entry_ = g.nodes_[n / 2U].get();
+  return g;
+}
+
+template <typename Data>
+void check_graph(graph<Data> const* g, unsigned const n) {
+  REQUIRE(g->nodes_.size() == n);
+  REQUIRE(g->edges_.size() == n);
+  CHECK((g->entry_ == g->nodes_[n / 2U].get()));
+  CHECK((g->null_ == nullptr));
+  for (auto i = 0U; i < n; ++i) {
+    auto const& nd = *g->nodes_[i];
+    CHECK(nd.id_ == i);
+    CHECK(nd.name_.view() == node_name(i));
+    REQUIRE(nd.edges_.size() == 1U);
+    CHECK((nd.edges_[0]->from_ == &nd));
+    CHECK((nd.edges_[0]->to_ == g->nodes_[(i + 1U) % n].get()));
+    REQUIRE(nd.payload_.size() == payload_size(i));
+    CHECK(nd.payload_[payload_size(i) - 1U] ==
+          uint64_t{i} * (payload_size(i) - 1U));
+  }
+}
+
+}  // namespace graph_fixture
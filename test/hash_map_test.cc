@@ -0,0 +1,204 @@
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/mmap.h"
+#include "cista/serialization.h"
+#endif
+
+TEST_CASE("hash_map insert find erase") {
+  namespace data = cista::raw;
+  data::hash_map<int, int> m;
+  CHECK(m.empty());
+  CHECK(m.find(1) == m.end());
+
+  for (auto i = 0; i != 1000; ++i) {
+    CHECK(m.emplace(i, i * 2).second);
+  }
+  CHECK(!m.emplace(7, 0).second);
+  CHECK(m.size() == 1000U);
+  CHECK(m.at(7) == 14);
+  CHECK(m.find(1000) == m.end());
+  CHECK(m.contains(uint8_t{3}));
+  CHECK_THROWS(m.at(1000));
+
+  for (auto i = 0; i < 1000; i += 2) {
+    CHECK(m.erase(i) == 1U);
+  }
+  CHECK(m.erase(0) == 0U);
+  CHECK(m.size() == 500U);
+
+  auto sum = 0;
+  for (auto const& [k, v] : m) {
+    CHECK(k % 2 == 1);
+    CHECK(v == 2 * k);
+    sum += k;
+  }
+  CHECK(sum == 250000);
+
+  for (auto i = 0; i < 1000; i += 2) {
+    m[i] = i;
+  }
+  CHECK(m.size() == 1000U);
+  CHECK(m[998] == 998);
+
+  for (auto it = m.begin(); it != m.end();) {
+    it = it->first < 500 ? m.erase(it) : std::next(it);
+  }
+  CHECK(m.size() == 500U);
+  CHECK(!m.contains(499));
+  CHECK(m.contains(500));
+
+  auto copy = m;
+  m.clear();
+  CHECK(m.empty());
+  CHECK(m.begin() == m.end());
+  CHECK(copy.size() == 500U);
+  CHECK(copy.at(999) == 1998);
+}
+
+TEST_CASE("hash_map floating point keys") {
+  namespace data = cista::raw;
+  data::hash_map<float, int> m;
+  m.emplace(1.0F, 1);
+  m.emplace(0.0F, 2);
+  CHECK(m.find(1.0) != m.end());
+  CHECK(m.find(1) != m.end());
+  CHECK(m.find(-0.0F) != m.end());
+  CHECK(m.find(2.0) == m.end());
+
+  // Independent of the byte order: hash of the IEEE 754 bit pattern.
+  auto const one = cista::hashing<float>{}(1.0F);
+  CHECK(one == cista::hashing<uint64_t>{}(uint64_t{0x3F800000U}));
+  CHECK(one == cista::hashing<float>{}(1.0));
+}
+
+TEST_CASE("hash_map random operations") {
+  cista::offset::hash_map<uint32_t, uint32_t> m;
+  std::map<uint32_t, uint32_t> ref;
+  auto gen = std::mt19937{42U};
+  auto dist = std::uniform_int_distribution<uint32_t>{0U, 2000U};
+  for (auto i = 0U; i != 100000U; ++i) {
+    auto const key = dist(gen);
+    if (i % 3U == 0U) {
+      CHECK(m.erase(key) == ref.erase(key));
+    } else {
+      m[key] = i;
+      ref[key] = i;
+    }
+  }
+  CHECK(m.size() == ref.size());
+  for (auto const& [k, v] : ref) {
+    CHECK(m.at(k) == v);
+  }
+  for (auto const& [k, v] : m) {
+    CHECK(ref.at(k) == v);
+  }
+}
+
+TEST_CASE("hash_set string heterogeneous lookup") {
+  namespace data = cista::offset;
+  data::hash_set<data::string> s{"a", "bb", "hello world hello world"};
+  CHECK(s.size() == 3U);
+  CHECK(s.contains(std::string_view{"bb"}));
+  CHECK(s.contains(std::string{"hello world hello world"}));
+  CHECK(s.contains("a"));
+  CHECK(!s.contains("c"));
+  CHECK(!s.emplace("a").second);
+}
+
+TEST_CASE("hash_map raw serialization") {
+  namespace data = cista::raw;
+  using map_t = data::hash_map<data::string, data::vector<int>>;
+
+  cista::byte_buf buf;
+  {
+    map_t m;
+    for (auto i = 0; i != 100; ++i) {
+      auto const key = "key number " + std::to_string(i);
+      auto& v = m[data::string{key.c_str(), data::string::owning}];
+      for (auto j = 0; j != i; ++j) {
+        v.push_back(j);
+      }
+    }
+    m.erase(std::string_view{"key number 5"});
+    buf = cista::serialize(m);
+  }
+
+  auto const m = cista::deserialize<map_t>(buf);
+  CHECK(m->size() == 99U);
+  CHECK(!m->contains(std::string_view{"key number 5"}));
+  CHECK(m->at(std::string_view{"key number 99"}).size() == 99U);
+  auto n = 0U;
+  for (auto const& [k, v] : *m) {
+    CHECK(k.view().substr(0U, 11U) == "key number ");
+    n += v.size();
+  }
+  CHECK(n == 99U * 100U / 2U - 5U);
+}
+
+TEST_CASE("hash_map offset mmap") {
+  namespace data = cista::offset;
+  using map_t = data::hash_map<uint32_t, data::string>;
+  constexpr auto const FILE_NAME = "hash_map_test.bin";
+  constexpr auto const MODE =
+      cista::mode::WITH_VERSION | cista::mode::WITH_INTEGRITY;
+
+  {
+    map_t m;
+    for (auto i = 0U; i != 10000U; ++i) {
+      auto const value = std::to_string(i);
+      m.emplace(i, data::string{value.c_str(), data::string::owning});
+    }
+    cista::buf<cista::mmap> mmap{cista::mmap{FILE_NAME}};
+    cista::serialize<MODE>(mmap, m);
+  }
+
+  auto b = cista::file(FILE_NAME, "r").content();
+  auto const m = cista::deserialize<map_t, MODE>(b);
+  CHECK(m->size() == 10000U);
+  CHECK(m->at(1234U) == "1234");
+  CHECK(m->find(10000U) == m->end());
+}
+
+TEST_CASE("hash_map deserialize corrupted control bytes") {
+  namespace data = cista::offset;
+  using map_t = data::hash_map<uint32_t, uint32_t>;
+
+  map_t m;
+  for (auto i = 0U; i != 20U; ++i) {
+    m.emplace(i, i);
+  }
+
+  auto const corrupt = [&](auto&& fn) {
+    auto buf = cista::serialize(m);
+    auto const copy = reinterpret_cast<map_t*>(&buf[0]);
+    fn(*copy);
+    CHECK_THROWS(cista::deserialize<map_t>(buf));
+  };
+
+  corrupt([](map_t& x) { static_cast<int8_t*>(x.ctrl_)[0] = -3; });
+  corrupt([](map_t& x) { static_cast<int8_t*>(x.ctrl_)[x.capacity_] = 0; });
+  corrupt([](map_t& x) { x.capacity_ = 32U; });
+  corrupt([](map_t& x) { ++x.size_; });
+  corrupt([](map_t& x) { x.growth_left_ = x.capacity_; });
+  corrupt([](map_t& x) {
+    for (auto i = 0U; i != x.capacity_ + 16U; ++i) {
+      if (i != x.capacity_) {
+        static_cast<int8_t*>(x.ctrl_)[i] =
+            cista::hash_storage_detail::DELETED;
+      }
+    }
+    x.size_ = 0U;
+    x.growth_left_ = 0U;
+  });
+
+  auto buf = cista::serialize(m);
+  CHECK(cista::deserialize<map_t>(buf)->at(19U) == 19U);
+}
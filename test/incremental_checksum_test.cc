@@ -0,0 +1,108 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#include "cista/targets/buffered_file.h"
+#include "cista/word_hash.h"
+#endif
+
+#include "graph_fixture.h"
+
+namespace incremental_checksum_test {
+
+using graph = graph_fixture::graph<graph_fixture::offset>;
+
+inline std::vector<char> random_bytes(std::size_t const n) {
+  auto rng = std::mt19937{static_cast<unsigned>(n)};
+  auto dist = std::uniform_int_distribution<int>{0, 255};
+  auto v = std::vector<char>(n);
+  for (auto& c : v) {
+    c = static_cast<char>(dist(rng));
+  }
+  return v;
+}
+
+}  // namespace incremental_checksum_test
+
+using namespace incremental_checksum_test;
+
+TEST_CASE("word hash parallel equals streaming") {
+  for (auto const n : {std::size_t{0U}, std::size_t{1U}, std::size_t{7U},
+                       std::size_t{8U}, std::size_t{1U} << 20U,
+                       (std::size_t{3U} << 20U) + 12345U}) {
+    auto const bytes = random_bytes(n);
+    auto const s = std::string_view{bytes.data(), bytes.size()};
+    auto const serial = cista::word_hash(s);
+    CHECK(cista::word_hash(s, 3U) == serial);
+    for (auto const step : {std::size_t{3U}, std::size_t{4096U}}) {
+      auto h = cista::word_hasher{};
+      for (auto i = std::size_t{0U}; i < s.size(); i += step) {
+        h.update(s.substr(i, step));
+      }
+      CHECK(h.finish() == serial);
+    }
+  }
+  CHECK(cista::word_hash("a") != cista::word_hash(std::string_view{"a\0", 2}));
+}
+
+TEST_CASE("buffered file tracks checksum of patched content") {
+  constexpr auto const FILENAME = "incremental_checksum_patch_test.bin";
+
+  auto const bytes = random_bytes(20000U);
+  cista::buffered_file f{FILENAME, 4096U};
+  f.track_checksum();
+  for (auto pos = std::size_t{0U}; pos < bytes.size(); pos += 13U) {
+    f.write(bytes.data() + pos, std::min(std::size_t{13U}, bytes.size() - pos),
+            0U);
+  }
+  f.write(bytes.data(), 5U, 64U);
+  for (auto pos = std::size_t{3U}; pos < 19990U; pos += 997U) {
+    f.write(pos, static_cast<uint32_t>(pos));
+  }
+  f.write(20033U, uint16_t{0xFFFFU});
+
+  auto const checksum = f.incremental_checksum(16U);
+  auto const content = cista::file(FILENAME, "r").content();
+  REQUIRE(content.size() == 20037U);
+  auto const s = std::string_view{reinterpret_cast<char const*>(content.data()),
+                                  content.size()};
+  CHECK(checksum == cista::word_hash(s.substr(16U)));
+}
+
+TEST_CASE("incremental checksum mode") {
+  constexpr auto const FILENAME = "incremental_checksum_test.bin";
+  constexpr auto const MODE = cista::mode::WITH_VERSION |
+                              cista::mode::WITH_INTEGRITY |
+                              cista::mode::INCREMENTAL_CHECKSUM;
+
+  auto g = graph_fixture::make_graph<graph_fixture::offset>(700U);
+  auto const expected = cista::serialize<MODE>(g);
+
+  {
+    cista::buffered_file f{FILENAME, 4096U};
+    cista::serialize<MODE>(f, g);
+  }
+  auto const from_buffered = cista::file(FILENAME, "r").content();
+  REQUIRE(from_buffered.size() == expected.size());
+  CHECK(std::memcmp(from_buffered.data(), expected.data(), expected.size()) ==
+        0);
+
+  {
+    cista::file f{FILENAME, "w+"};
+    cista::serialize<MODE>(f, g);
+  }
+  auto b = cista::file(FILENAME, "r").content();
+  REQUIRE(b.size() == expected.size());
+  CHECK(std::memcmp(b.data(), expected.data(), expected.size()) == 0);
+
+  graph_fixture::check_graph(cista::deserialize<graph, MODE>(b, 2U), 700U);
+
+  b[b.size() - 1U] ^= 1U;
+  CHECK_THROWS((cista::deserialize<graph, MODE>(b)));
+}
@@ -0,0 +1,236 @@
+#include <cinttypes>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#endif
+
+#include "graph_fixture.h"
+
+namespace layout_test {
+
+namespace data = cista::offset;
+
+struct node {
+  uint32_t id_;
+  data::vector<data::unique_ptr<node>> children_;
+  data::ptr<node> parent_;
+};
+
+// Complete binary tree, ids in breadth first order.
+inline data::unique_ptr<node> make_tree(uint32_t const id, uint32_t const n,
+                                        node* parent) {
+  auto x = data::make_unique<node>(node{id, {}, parent});
+  for (auto const child : {2U * id + 1U, 2U * id + 2U}) {
+    if (child < n) {
+      x->children_.emplace_back(make_tree(child, n, x.get()));
+    }
+  }
+  return x;
+}
+
+struct prioritized {
+  int32_t priority_;
+  data::vector<data::unique_ptr<prioritized>> children_;
+};
+
+inline int32_t layout_priority(prioritized const& x) { return x.priority_; }
+
+struct plain {
+  uint32_t id_;
+};
+
+struct holder {
+  int32_t priority_;
+  data::unique_ptr<plain> plain_;
+};
+
+inline int32_t layout_priority(holder const& x) { return x.priority_; }
+
+template <typename Fn>
+void for_each_node(node const& n, Fn&& fn) {
+  fn(n);
+  for (auto const& c : n.children_) {
+    for_each_node(*c, fn);
+  }
+}
+
+// Ids of the nodes in the order of their addresses.
+inline std::vector<uint32_t> memory_order(node const& root) {
+  auto nodes = std::vector<node const*>{};
+  for_each_node(root, [&](node const& n) { nodes.push_back(&n); });
+  std::sort(begin(nodes), end(nodes));
+  auto ids = std::vector<uint32_t>{};
+  for (auto const n : nodes) {
+    ids.push_back(n->id_);
+  }
+  return ids;
+}
+
+// Number of distinct 4 KiB pages (relative to base) holding the first n
+// nodes of a breadth first walk and their children vectors.
+inline std::size_t pages_touched(node const& root, std::size_t const n,
+                                 uint8_t const* base) {
+  auto pages = std::vector<std::size_t>{};
+  auto const add = [&](void const* p) {
+    pages.push_back(static_cast<std::size_t>(
+                        reinterpret_cast<uint8_t const*>(p) - base) /
+                    4096U);
+  };
+  auto level = std::vector<node const*>{&root};
+  for (auto visited = std::size_t{0U}; !level.empty() && visited < n;) {
+    auto next = std::vector<node const*>{};
+    for (auto const x : level) {
+      if (visited++ == n) {
+        break;
+      }
+      add(x);
+      if (!x->children_.empty()) {
+        add(x->children_.begin());
+      }
+      for (auto const& c : x->children_) {
+        next.push_back(c.get());
+      }
+    }
+    level = std::move(next);
+  }
+  std::sort(begin(pages), end(pages));
+  return static_cast<std::size_t>(
+      std::distance(begin(pages), std::unique(begin(pages), end(pages))));
+}
+
+}  // namespace layout_test
+
+using namespace layout_test;
+
+TEST_CASE("layout depth first by default") {
+  auto const tree = make_tree(0U, 7U, nullptr);
+  auto buf = cista::serialize(tree);
+  auto const root = cista::deserialize<data::unique_ptr<node>>(buf);
+  CHECK(memory_order(**root) ==
+        std::vector<uint32_t>{0U, 1U, 3U, 4U, 2U, 5U, 6U});
+}
+
+TEST_CASE("layout breadth first") {
+  constexpr auto const MODE =
+      cista::mode::BREADTH_FIRST_LAYOUT | cista::mode::WITH_INTEGRITY;
+
+  auto const tree = make_tree(0U, 100U, nullptr);
+  auto buf = cista::serialize<MODE>(tree);
+  auto const root = cista::deserialize<data::unique_ptr<node>, MODE>(buf);
+
+  auto expected = std::vector<uint32_t>(100U);
+  for (auto i = 0U; i != 100U; ++i) {
+    expected[i] = i;
+  }
+  CHECK(memory_order(**root) == expected);
+}
+
+TEST_CASE("layout breadth first packs top levels into fewer pages") {
+  constexpr auto const N = (1U << 16U) - 1U;
+  constexpr auto const TOP = (1U << 10U) - 1U;  // first 10 levels
+
+  auto const tree = make_tree(0U, N, nullptr);
+  auto dfs_buf = cista::serialize(tree);
+  auto bfs_buf = cista::serialize<cista::mode::BREADTH_FIRST_LAYOUT>(tree);
+  auto const dfs = cista::deserialize<data::unique_ptr<node>>(dfs_buf);
+  auto const bfs = cista::deserialize<data::unique_ptr<node>,
+                                      cista::mode::BREADTH_FIRST_LAYOUT>(
+      bfs_buf);
+
+  auto const dfs_pages = pages_touched(**dfs, TOP, dfs_buf.data());
+  auto const bfs_pages = pages_touched(**bfs, TOP, bfs_buf.data());
+  CHECK(bfs_pages * 4U < dfs_pages);
+}
+
+TEST_CASE("layout breadth first keeps pointers") {
+  constexpr auto const MODE = cista::mode::BREADTH_FIRST_LAYOUT;
+
+  auto raw_graph = graph_fixture::make_graph<graph_fixture::raw>(100U);
+  auto raw_buf = cista::serialize<MODE>(raw_graph);
+  graph_fixture::check_graph(
+      cista::deserialize<decltype(raw_graph), MODE>(raw_buf), 100U);
+
+  auto offset_graph = graph_fixture::make_graph<graph_fixture::offset>(100U);
+  auto offset_buf = cista::serialize<MODE>(offset_graph);
+  graph_fixture::check_graph(
+      cista::deserialize<decltype(offset_graph), MODE>(offset_buf), 100U);
+}
+
+TEST_CASE("layout priority") {
+  using tree_t = data::vector<data::unique_ptr<prioritized>>;
+
+  tree_t roots;
+  for (auto const p : {3, 1, 2}) {
+    auto x = data::make_unique<prioritized>(prioritized{p, {}});
+    x->children_.emplace_back(
+        data::make_unique<prioritized>(prioritized{p - 10, {}}));
+    x->children_.emplace_back(
+        data::make_unique<prioritized>(prioritized{0, {}}));
+    roots.emplace_back(std::move(x));
+  }
+
+  auto buf = cista::serialize<cista::mode::BREADTH_FIRST_LAYOUT>(roots);
+  auto const d =
+      cista::deserialize<tree_t, cista::mode::BREADTH_FIRST_LAYOUT>(buf);
+
+  // The lowest priority of the queue is written next. Initially, the
+  // queue holds the roots. Written objects add their children:
+  // 1, -9, 0 (child of 1), 2, -8, 0 (child of 2), 3, -7, 0 (child of 3).
+  auto const address = [](data::unique_ptr<prioritized> const& x) {
+    return reinterpret_cast<uintptr_t>(x.get());
+  };
+  auto order = std::vector<uintptr_t>{};
+  for (auto const i : {1U, 2U, 0U}) {
+    order.push_back(address((*d)[i]));
+    order.push_back(address((*d)[i]->children_[0]));
+    order.push_back(address((*d)[i]->children_[1]));
+  }
+  CHECK(std::is_sorted(begin(order), end(order)));
+  CHECK((*d)[0]->children_[0]->priority_ == -7);
+}
+
+TEST_CASE("layout priority with types without priority") {
+  using roots_t = data::vector<data::unique_ptr<holder>>;
+
+  roots_t roots;
+  for (auto const p : {1, -1}) {
+    roots.emplace_back(data::make_unique<holder>(
+        holder{p, data::make_unique<plain>(plain{static_cast<uint32_t>(p)})}));
+  }
+
+  auto buf = cista::serialize<cista::mode::BREADTH_FIRST_LAYOUT>(roots);
+  auto const d =
+      cista::deserialize<roots_t, cista::mode::BREADTH_FIRST_LAYOUT>(buf);
+
+  // plain objects have priority 0: -1, its plain, 1, its plain.
+  auto const order = std::vector<uintptr_t>{
+      reinterpret_cast<uintptr_t>((*d)[1].get()),
+      reinterpret_cast<uintptr_t>((*d)[1]->plain_.get()),
+      reinterpret_cast<uintptr_t>((*d)[0].get()),
+      reinterpret_cast<uintptr_t>((*d)[0]->plain_.get())};
+  CHECK(std::is_sorted(begin(order), end(order)));
+}
+
+TEST_CASE("layout queues only exist in breadth first mode") {
+  using default_ctx = cista::serialization_context<cista::buf<>,
+                                                   cista::mode::NONE>;
+  using bfs_ctx = cista::serialization_context<
+      cista::buf<>, cista::mode::BREADTH_FIRST_LAYOUT>;
+  static_assert(std::is_same_v<decltype(default_ctx::deferred_fifo_),
+                               cista::unused_member>);
+  static_assert(std::is_same_v<decltype(default_ctx::deferred_heap_),
+                               cista::unused_member>);
+  static_assert(
+      std::is_same_v<decltype(default_ctx::blocks_), cista::unused_member>);
+  static_assert(!std::is_same_v<decltype(bfs_ctx::deferred_fifo_),
+                                cista::unused_member>);
+  static_assert(
+      std::is_same_v<decltype(bfs_ctx::blocks_), cista::unused_member>);
+}
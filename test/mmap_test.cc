@@ -0,0 +1,148 @@
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/mmap.h"
+#include "cista/serialization.h"
+#endif
+
+namespace mmap_test {
+
+namespace data = cista::offset;
+
+struct node {
+  uint32_t id_{0};
+  data::string name_;
+};
+
+}  // namespace mmap_test
+
+using namespace mmap_test;
+
+TEST_CASE("mmap grow keeps content") {
+  constexpr auto const FILENAME = "mmap_grow_test.bin";
+
+  {
+    cista::mmap m{FILENAME};
+    for (auto i = 0U; i != 100000U; ++i) {
+      m.resize(i + 1U);
+      m[i] = static_cast<unsigned char>(i % 251U);
+    }
+    for (auto i = 0U; i != 100000U; ++i) {
+      REQUIRE(m[i] == static_cast<unsigned char>(i % 251U));
+    }
+  }
+
+  auto const b = cista::file(FILENAME, "r").content();
+  REQUIRE(b.size() == 100000U);
+  for (auto i = 0U; i != 100000U; ++i) {
+    REQUIRE(b[i] == static_cast<unsigned char>(i % 251U));
+  }
+}
+
+#ifndef _MSC_VER
+TEST_CASE("mmap reserved address space does not move") {
+  constexpr auto const FILENAME = "mmap_reserve_test.bin";
+
+  {
+    cista::mmap m{FILENAME};
+    m.reserve_address_space(64U * 1024U * 1024U);
+    m.resize(1U);
+    auto const data = m.data();
+    for (auto i = 0U; i != 1000000U; ++i) {
+      m.resize(i + 1U);
+      m[i] = static_cast<unsigned char>(i % 251U);
+    }
+    CHECK(m.data() == data);
+  }
+
+  auto const b = cista::file(FILENAME, "r").content();
+  REQUIRE(b.size() == 1000000U);
+  for (auto i = 0U; i != 1000000U; ++i) {
+    REQUIRE(b[i] == static_cast<unsigned char>(i % 251U));
+  }
+}
+#endif
+
+TEST_CASE("serialize to mmap with reserved address space") {
+  constexpr auto const FILENAME = "mmap_reserve_serialize_test.bin";
+
+  data::vector<node> v;
+  for (auto i = 0U; i != 10000U; ++i) {
+    auto& n = v.emplace_back();
+    n.id_ = i;
+    n.name_.set_owning("NODE NAME LONGER THAN 15 CHARS " + std::to_string(i));
+  }
+
+  {
+    cista::buf<cista::mmap> mmap{cista::mmap{FILENAME}};
+    mmap.buf_.reserve_address_space(1024U * 1024U * 1024U);
+    cista::serialize(mmap, v);
+  }
+
+  auto const expected = cista::serialize(v);
+  auto b = cista::file(FILENAME, "r").content();
+  REQUIRE(b.size() == expected.size());
+  CHECK(std::memcmp(b.data(), expected.data(), b.size()) == 0);
+
+  auto const deserialized = cista::deserialize<data::vector<node>>(b);
+  REQUIRE(deserialized->size() == 10000U);
+  CHECK((*deserialized)[9999].id_ == 9999U);
+}
+
+TEST_CASE("mmap read with access hints") {
+  constexpr auto const FILENAME = "mmap_advice_test.bin";
+
+  data::vector<node> v;
+  for (auto i = 0U; i != 10000U; ++i) {
+    auto& n = v.emplace_back();
+    n.id_ = i;
+    n.name_.set_owning("NODE NAME LONGER THAN 15 CHARS " + std::to_string(i));
+  }
+
+  {
+    cista::buf<cista::mmap> mmap{cista::mmap{FILENAME}};
+    cista::serialize(mmap, v);
+  }
+
+  using flags = cista::mmap::flags;
+  auto m = cista::mmap{FILENAME, cista::mmap::protection::READ,
+                       flags::POPULATE | flags::HUGE_PAGES};
+  m.advise(cista::mmap::advice::RANDOM);
+  m.advise(cista::mmap::advice::SEQUENTIAL, 100U, 5000U);
+  m.prefetch(m.size() / 2U, m.size());
+  m.prefetch(m.size() + 1U, 10U);  // out of range: ignored
+
+  auto const deserialized = cista::deserialize<data::vector<node>>(m);
+  REQUIRE(deserialized->size() == 10000U);
+  CHECK((*deserialized)[1234].name_ ==
+        std::string{"NODE NAME LONGER THAN 15 CHARS 1234"}.c_str());
+}
+
+TEST_CASE("mmap private copy-on-write") {
+  constexpr auto const FILENAME = "mmap_private_test.bin";
+
+  cista::raw::vector<cista::raw::string> v;
+  for (auto i = 0U; i != 1000U; ++i) {
+    v.emplace_back().set_owning("A STRING LONGER THAN 15 CHARS " +
+                                std::to_string(i));
+  }
+  {
+    cista::file f{FILENAME, "w+"};
+    cista::serialize(f, v);
+  }
+  auto const before = cista::file(FILENAME, "r").content();
+
+  {
+    auto m = cista::mmap{FILENAME, cista::mmap::protection::PRIVATE};
+    auto const deserialized =
+        cista::deserialize<cista::raw::vector<cista::raw::string>>(m);
+    REQUIRE(deserialized->size() == 1000U);
+    CHECK((*deserialized)[999] == v[999]);
+  }
+
+  auto const after = cista::file(FILENAME, "r").content();
+  REQUIRE(after.size() == before.size());
+  CHECK(std::memcmp(after.data(), before.data(), after.size()) == 0);
+}
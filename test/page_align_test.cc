@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cinttypes>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/mmap.h"
+#include "cista/serialization.h"
+#include "cista/targets/buffered_file.h"
+#endif
+
+#include "graph_fixture.h"
+
+namespace page_align_test {
+
+namespace data = cista::offset;
+
+struct tables {
+  data::vector<uint8_t> small_;
+  data::vector<uint32_t> large_;
+  data::vector<uint16_t> tiny_;
+  data::vector<uint8_t> large_bytes_;
+};
+
+inline tables make_tables() {
+  tables t;
+  for (auto i = 0U; i != 100U; ++i) {
+    t.small_.push_back(static_cast<uint8_t>(i));
+    t.tiny_.push_back(static_cast<uint16_t>(i));
+  }
+  for (auto i = 0U; i != 20000U; ++i) {
+    t.large_.push_back(i);
+  }
+  for (auto i = 0U; i != 70000U; ++i) {
+    t.large_bytes_.push_back(static_cast<uint8_t>(i % 251U));
+  }
+  return t;
+}
+
+template <typename T>
+std::size_t offset_in(cista::byte_buf const& b, T const* p) {
+  return static_cast<std::size_t>(reinterpret_cast<uint8_t const*>(p) -
+                                  b.data());
+}
+
+inline std::size_t round_up(std::size_t const x, std::size_t const a) {
+  return (x + a - 1U) / a * a;
+}
+
+}  // namespace page_align_test
+
+using namespace page_align_test;
+
+TEST_CASE("page aligned large vectors") {
+  constexpr auto const MODE = cista::mode::PAGE_ALIGN_LARGE_VECTORS |
+                              cista::mode::WITH_VERSION |
+                              cista::mode::WITH_INTEGRITY;
+
+  auto const t = make_tables();
+  auto buf = cista::serialize<MODE>(t);
+  CHECK(cista::serialized_size_of<MODE>(t) == buf.size());
+  CHECK(cista::serialize(t).size() < buf.size());
+
+  auto const d = cista::deserialize<tables, MODE>(buf);
+  CHECK(offset_in(buf, d->large_.begin()) % cista::PAGE_ALIGNMENT == 0U);
+  CHECK(offset_in(buf, d->large_bytes_.begin()) % cista::PAGE_ALIGNMENT ==
+        0U);
+  CHECK(offset_in(buf, d->tiny_.begin()) ==  // end of large_ padded
+        round_up(offset_in(buf, d->large_.begin()) + 20000U * sizeof(uint32_t),
+                 cista::PAGE_ALIGNMENT));
+  CHECK(offset_in(buf, d->small_.begin()) ==  // small: not aligned
+        offset_in(buf, d) + sizeof(tables));
+  CHECK(buf.size() % cista::PAGE_ALIGNMENT == 0U);  // large_bytes_ is last
+  CHECK(d->large_[19999] == 19999U);
+  CHECK(d->large_bytes_[69999] == 69999U % 251U);
+  CHECK(d->tiny_[99] == 99U);
+}
+
+TEST_CASE("page aligned large vectors mmap drop") {
+  constexpr auto const FILENAME = "page_align_test.bin";
+  constexpr auto const MODE = cista::mode::PAGE_ALIGN_LARGE_VECTORS;
+  constexpr auto const N = 5000U;  // nodes_: 80 KB of unique_ptrs
+
+  using graph = graph_fixture::graph<graph_fixture::offset>;
+  {
+    auto const g = graph_fixture::make_graph<graph_fixture::offset>(N);
+    auto f = cista::buffered_file{FILENAME};
+    cista::serialize<MODE>(f, g);
+  }
+
+  auto m = cista::mmap{FILENAME, cista::mmap::protection::READ};
+  auto const d = cista::deserialize<graph, MODE>(m);
+  auto const nodes = reinterpret_cast<uint8_t const*>(d->nodes_.begin());
+  auto const offset = static_cast<std::size_t>(nodes - m.data());
+  auto const size = d->nodes_.size() * sizeof(d->nodes_[0]);
+  REQUIRE(size >= cista::LARGE_VECTOR_SIZE);
+  CHECK(offset % cista::PAGE_ALIGNMENT == 0U);
+  CHECK(reinterpret_cast<uintptr_t>(nodes) % 4096U == 0U);
+
+  // Zero padding up to the next boundary: no other data on the last page.
+  auto const end = round_up(offset + size, cista::PAGE_ALIGNMENT);
+  REQUIRE(end <= m.size());
+  CHECK(std::all_of(nodes + size, nodes - offset + end,
+                    [](uint8_t const b) { return b == 0U; }));
+
+  m.prefetch(offset, size);
+  m.drop(offset, size);
+  graph_fixture::check_graph(d, N);
+}
+
+TEST_CASE("mmap drop keeps changes to neighbours in private map") {
+  constexpr auto const FILENAME = "page_align_drop_test.bin";
+  {  // Not page aligned: small_ / tiny_ share the first / last page of large_.
+    auto const t = make_tables();
+    auto f = cista::buffered_file{FILENAME};
+    cista::serialize(f, t);
+  }
+
+  auto m = cista::mmap{FILENAME, cista::mmap::protection::PRIVATE};
+  auto const d = cista::deserialize<tables>(m);
+  auto const large = reinterpret_cast<uint8_t const*>(d->large_.begin());
+  auto const offset = static_cast<std::size_t>(large - m.data());
+  auto const size = d->large_.size() * sizeof(uint32_t);
+  REQUIRE(offset % 4096U != 0U);
+
+  d->small_[99] = 42U;
+  d->tiny_[0] = 4242U;
+  d->large_[0] = 7U;  // first page is shared: kept
+  m.drop(offset, size);
+
+  CHECK(d->small_[99] == 42U);
+  CHECK(d->tiny_[0] == 4242U);
+  CHECK(d->large_[0] == 7U);
+  CHECK(d->large_[10000] == 10000U);
+}
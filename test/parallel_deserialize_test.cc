@@ -0,0 +1,73 @@
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#endif
+
+#include "graph_fixture.h"
+
+namespace parallel_deserialize_test {
+
+namespace data = cista::raw;
+
+using node = graph_fixture::node<graph_fixture::raw>;
+
+// Arrays are split across threads like vectors.
+struct graph {
+  graph_fixture::graph<graph_fixture::raw> graph_;
+  data::array<data::ptr<node>, 2048> lookup_;
+};
+
+inline graph make_graph(unsigned const n) {
+  graph g;
+  g.graph_ = graph_fixture::make_graph<graph_fixture::raw>(n);
+  for (auto i = 0U; i < g.lookup_.size(); ++i) {
+    g.lookup_[i] = g.graph_.nodes_[i % n].get();
+  }
+  return g;
+}
+
+inline void check_graph(graph const* g, unsigned const n) {
+  graph_fixture::check_graph(&g->graph_, n);
+  for (auto i = 0U; i < g->lookup_.size(); ++i) {
+    CHECK(g->lookup_[i] == g->graph_.nodes_[i % n].get());
+  }
+}
+
+}  // namespace parallel_deserialize_test
+
+using namespace parallel_deserialize_test;
+
+TEST_CASE("parallel deserialize matches serial") {
+  constexpr auto const N = 5000U;
+  auto g = make_graph(N);
+  auto serial_buf = cista::serialize(g);
+  auto parallel_buf = cista::serialize(g);
+
+  check_graph(cista::deserialize<graph>(serial_buf), N);
+  check_graph(cista::deserialize<graph>(parallel_buf, 4U), N);
+}
+
+TEST_CASE("parallel deserialize with relocations") {
+  constexpr auto const N = 5000U;
+  constexpr auto const MODE = cista::mode::WITH_RELOCATIONS;
+  auto g = make_graph(N);
+  auto buf = cista::serialize<MODE>(g);
+  check_graph(cista::unchecked_deserialize<graph, MODE>(buf, 0U), N);
+}
+
+TEST_CASE("parallel deserialize propagates errors") {
+  auto g = make_graph(2000U);
+  auto buf = cista::serialize(g);
+  auto broken = cista::serialize(g);
+
+  // Corrupt the last node pointer (processed by a worker thread).
+  auto const last = reinterpret_cast<uint8_t const*>(
+      &cista::deserialize<graph>(buf)->graph_.nodes_[1999]);
+  auto const pos = static_cast<std::size_t>(last - buf.data());
+  auto const invalid = std::numeric_limits<cista::offset_t>::max() / 2;
+  std::memcpy(&broken[pos], &invalid, sizeof(invalid));
+  CHECK_THROWS(cista::deserialize<graph>(broken, 4U));
+}
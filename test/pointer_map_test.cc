@@ -0,0 +1,50 @@
+#include "doctest.h"
+
+#include <vector>
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/offset_t.h"
+#include "cista/pointer_map.h"
+#endif
+
+TEST_CASE("pointer map insert find") {
+  std::vector<uint64_t> values(10000);
+
+  cista::pointer_map<cista::offset_t> m;
+  CHECK(m.find(&values[0]) == nullptr);
+
+  for (auto i = 0U; i < values.size(); ++i) {
+    m[&values[i]] = static_cast<cista::offset_t>(i);
+  }
+  CHECK(m.size() == values.size());
+
+  for (auto i = 0U; i < values.size(); ++i) {
+    auto const offset = m.find(&values[i]);
+    REQUIRE(offset != nullptr);
+    CHECK(*offset == static_cast<cista::offset_t>(i));
+  }
+
+  uint64_t not_inserted;
+  CHECK(m.find(&not_inserted) == nullptr);
+
+  m[&values[7]] = 77;
+  CHECK(m.size() == values.size());
+  CHECK(*m.find(&values[7]) == 77);
+}
+
+TEST_CASE("pointer map reserve keeps entries") {
+  std::vector<uint32_t> values(100);
+
+  cista::pointer_map<cista::offset_t> m;
+  for (auto i = 0U; i < 50U; ++i) {
+    m[&values[i]] = static_cast<cista::offset_t>(i);
+  }
+  m.reserve(100000);
+  for (auto i = 0U; i < 50U; ++i) {
+    REQUIRE(m.find(&values[i]) != nullptr);
+    CHECK(*m.find(&values[i]) == static_cast<cista::offset_t>(i));
+  }
+  CHECK(m.find(&values[50]) == nullptr);
+}
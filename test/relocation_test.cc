@@ -0,0 +1,124 @@
+#include <cstddef>
+#include <cstring>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#endif
+
+#include "graph_fixture.h"
+
+namespace relocation_test {
+
+using graph = graph_fixture::graph<graph_fixture::raw>;
+
+inline graph make_graph(unsigned const n) {
+  return graph_fixture::make_graph<graph_fixture::raw>(n);
+}
+
+template <cista::mode Mode>
+void check_graph(cista::byte_buf& buf, unsigned const n) {
+  graph_fixture::check_graph(cista::deserialize<graph, Mode>(buf), n);
+}
+
+struct custom {
+  cista::raw::ptr<int> ptr_;
+};
+
+template <typename Ctx>
+void deserialize(Ctx const&, custom*) {}
+
+struct with_custom {
+  cista::raw::vector<cista::raw::unique_ptr<custom>> custom_;
+};
+
+}  // namespace relocation_test
+
+using namespace relocation_test;
+
+TEST_CASE("relocation table raw graph") {
+  constexpr auto const MODE = cista::mode::WITH_RELOCATIONS;
+  auto g = make_graph(100U);
+  auto buf = cista::serialize<MODE>(g);
+  auto unchecked_buf = cista::serialize<MODE>(g);
+  check_graph<MODE>(buf, 100U);
+  check_graph<MODE | cista::mode::UNCHECKED>(unchecked_buf, 100U);
+}
+
+TEST_CASE("relocation table rejects custom deserialize functions") {
+  using ctx_t = cista::deserialization_context<cista::mode::WITH_RELOCATIONS |
+                                               cista::mode::UNCHECKED>;
+  static_assert(!cista::has_custom_deserialize<ctx_t, graph>());
+  static_assert(cista::has_custom_deserialize<ctx_t, custom>());
+  static_assert(cista::has_custom_deserialize<ctx_t, with_custom>());
+}
+
+TEST_CASE("relocation table with version and integrity") {
+  constexpr auto const MODE = cista::mode::WITH_RELOCATIONS |
+                              cista::mode::WITH_VERSION |
+                              cista::mode::WITH_INTEGRITY;
+  auto g = make_graph(10U);
+  auto buf = cista::serialize<MODE>(g);
+  check_graph<MODE>(buf, 10U);
+}
+
+TEST_CASE("relocation table detects invalid offsets") {
+  constexpr auto const MODE = cista::mode::WITH_RELOCATIONS;
+  auto g = make_graph(3U);
+  auto buf = cista::serialize<MODE>(g);
+
+  // Let the (last) relocation point out of the buffer.
+  auto const last_slot = *reinterpret_cast<cista::offset_t*>(
+      &buf[0] + buf.size() - sizeof(cista::offset_t));
+  *reinterpret_cast<cista::offset_t*>(&buf[0] + last_slot) =
+      static_cast<cista::offset_t>(buf.size());
+  CHECK_THROWS((cista::deserialize<graph, MODE>(buf)));
+}
+
+TEST_CASE("relocation table keeps structural checks") {
+  constexpr auto const MODE = cista::mode::WITH_RELOCATIONS;
+  auto g = make_graph(3U);
+  auto buf = cista::serialize<MODE>(g);
+
+  // Sizes are not covered by the relocation table.
+  using nodes_t = decltype(graph::nodes_);
+  auto const size = uint32_t{0x7FFFFFFFU};
+  for (auto const member : {offsetof(nodes_t, allocated_size_),
+                            offsetof(nodes_t, used_size_)}) {
+    std::memcpy(buf.data() + cista::data_start(MODE) + member, &size,
+                sizeof(size));
+  }
+  CHECK_THROWS((cista::deserialize<graph, MODE>(buf)));
+}
+
+TEST_CASE("relocation table offset mode") {
+  namespace data = cista::offset;
+  constexpr auto const MODE = cista::mode::WITH_RELOCATIONS;
+
+  struct serialize_me {
+    data::vector<data::string> strings_;
+    data::unique_ptr<int> ptr_;
+  };
+
+  cista::byte_buf buf;
+  {
+    serialize_me obj;
+    obj.strings_.emplace_back("The quick brown fox jumps over the lazy dog");
+    obj.strings_.emplace_back("short");
+    obj.ptr_ = data::make_unique<int>(77);
+    buf = cista::serialize<MODE>(obj);
+  }
+
+  auto const s = cista::deserialize<serialize_me, MODE>(buf);
+  CHECK(s->strings_[0] == "The quick brown fox jumps over the lazy dog");
+  CHECK(s->strings_[1] == "short");
+  CHECK(*s->ptr_ == 77);
+
+  // No raw pointers: the unchecked relocation pass has nothing to do.
+  auto const u = cista::unchecked_deserialize<serialize_me, MODE>(buf);
+  CHECK(u->strings_[0] == "The quick brown fox jumps over the lazy dog");
+  CHECK(*u->ptr_ == 77);
+}
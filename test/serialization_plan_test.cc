@@ -0,0 +1,121 @@
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#endif
+
+namespace serialization_plan_test {
+
+namespace data = cista::offset;
+
+struct inner {
+  uint16_t a_;
+  uint32_t b_;
+  double c_, d_;
+  data::string s_;
+};
+
+struct outer {
+  inner i_;
+  int64_t x_, y_;
+  data::vector<inner> v_;
+  uint8_t z_;
+  inner j_;
+};
+
+// Too large to be byte swapped in a stack buffer.
+struct large {
+  cista::array<uint8_t, 600> pad_;
+  uint32_t x_;
+  float f_;  // merged into one swap run with x_ and y_
+  uint32_t y_;
+  data::string s_;
+};
+
+outer make_outer() {
+  auto const long_str = "a long string which is not stored inline";
+  outer o;
+  o.i_ = inner{1U, 2U, 3.0, 4.0, data::string{long_str}};
+  o.x_ = -5;
+  o.y_ = 6;
+  o.v_.push_back(inner{7U, 8U, 9.0, 10.0, data::string{"short"}});
+  o.z_ = 11U;
+  o.j_ = inner{12U, 13U, 14.0, 15.0, data::string{long_str}};
+  return o;
+}
+
+template <cista::mode const Mode>
+void check_round_trip() {
+  auto o = make_outer();
+  auto buf = cista::serialize<Mode>(o);
+  auto const d = cista::deserialize<outer, Mode>(buf);
+  CHECK(d->i_.a_ == 1U);
+  CHECK(d->i_.b_ == 2U);
+  CHECK(d->i_.c_ == 3.0);
+  CHECK(d->i_.d_ == 4.0);
+  CHECK(d->i_.s_ == o.i_.s_);
+  CHECK(d->x_ == -5);
+  CHECK(d->y_ == 6);
+  REQUIRE(d->v_.size() == 1U);
+  CHECK(d->v_[0].b_ == 8U);
+  CHECK(d->v_[0].d_ == 10.0);
+  CHECK(d->v_[0].s_ == "short");
+  CHECK(d->z_ == 11U);
+  CHECK(d->j_.a_ == 12U);
+  CHECK(d->j_.c_ == 14.0);
+  CHECK(d->j_.s_ == o.j_.s_);
+}
+
+}  // namespace serialization_plan_test
+
+using namespace serialization_plan_test;
+
+TEST_CASE("serialization plan round trip") {
+  check_round_trip<cista::mode::NONE>();
+  check_round_trip<cista::mode::SERIALIZE_BIG_ENDIAN>();
+}
+
+TEST_CASE("serialization plan large aggregate big endian") {
+  constexpr auto const MODE = cista::mode::SERIALIZE_BIG_ENDIAN;
+  large l;
+  l.pad_[599] = 1U;
+  l.x_ = 2U;
+  l.f_ = 2.5F;
+  l.y_ = 3U;
+  l.s_ = data::string{"a long string which is not stored inline"};
+  auto buf = cista::serialize<MODE>(l);
+  auto const d = cista::deserialize<large, MODE>(buf);
+  CHECK(d->pad_[599] == 1U);
+  CHECK(d->x_ == 2U);
+  CHECK(d->f_ == 2.5F);
+  CHECK(d->y_ == 3U);
+  CHECK(d->s_ == l.s_);
+
+  using ctx = cista::serialization_context<cista::buf<>, MODE>;
+  auto const& plan = cista::serialize_plan<ctx>(l);
+  REQUIRE(plan.size_ == 3U);  // pad_, run of x_ f_ y_, s_
+  CHECK(plan.slots_[1].swap_size_ == 4U);
+  CHECK(plan.slots_[1].count_ == 3U);
+  CHECK(plan.slots_[1].fn_ == nullptr);
+}
+
+TEST_CASE("serialization plan flattens nested aggregates") {
+  auto o = make_outer();
+
+  // Only the strings and the vector need to be visited.
+  using le_ctx = cista::deserialization_context<cista::mode::NONE>;
+  CHECK(cista::deserialize_plan<le_ctx>(o).size_ == 3U);
+
+  // Per inner: a_, b_, run of c_ and d_, s_. Then: run of x_ and y_, v_.
+  // The single byte z_ does not need to be swapped.
+  using be_ctx =
+      cista::deserialization_context<cista::mode::SERIALIZE_BIG_ENDIAN>;
+  auto const& be_plan = cista::deserialize_plan<be_ctx>(o);
+  CHECK(be_plan.size_ == 10U);
+  CHECK(be_plan.slots_[2].swap_size_ == 8U);
+  CHECK(be_plan.slots_[2].count_ == 2U);
+  CHECK(be_plan.slots_[2].offset_ ==
+        static_cast<cista::offset_t>(offsetof(inner, c_)));
+}
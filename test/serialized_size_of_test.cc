@@ -0,0 +1,94 @@
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/mmap.h"
+#include "cista/serialization.h"
+#endif
+
+#include "graph_fixture.h"
+
+namespace serialized_size_of_test {
+
+namespace data = cista::raw;
+
+// Followed by a byte aligned unique_ptr target (no trailing padding).
+struct graph {
+  graph_fixture::graph<graph_fixture::raw> graph_;
+  data::unique_ptr<uint8_t> single_byte_;
+};
+
+struct alignas(32) wide {
+  uint8_t x_{0};
+};
+
+struct with_wide {
+  uint8_t a_{0};
+  data::vector<wide> w_;
+};
+
+inline graph make_graph(unsigned const n) {
+  graph g;
+  g.graph_ = graph_fixture::make_graph<graph_fixture::raw>(n);
+  g.single_byte_ = data::make_unique<uint8_t>(uint8_t{7U});
+  return g;
+}
+
+}  // namespace serialized_size_of_test
+
+using namespace serialized_size_of_test;
+
+TEST_CASE("serialized_size_of matches serialize") {
+  auto g = make_graph(100U);
+  CHECK(cista::serialized_size_of(g) == cista::serialize(g).size());
+
+  constexpr auto const MODE = cista::mode::WITH_VERSION |
+                              cista::mode::WITH_INTEGRITY |
+                              cista::mode::WITH_RELOCATIONS;
+  CHECK(cista::serialized_size_of<MODE>(g) == cista::serialize<MODE>(g).size());
+
+  with_wide w;
+  w.w_.resize(3U);
+  CHECK(cista::serialized_size_of(w) == cista::serialize(w).size());
+
+  auto empty = data::vector<int>{};
+  CHECK(cista::serialized_size_of(empty) == cista::serialize(empty).size());
+}
+
+TEST_CASE("serialize into reserved buffer") {
+  auto g = make_graph(100U);
+  auto const size = cista::serialized_size_of(g);
+
+  cista::buf<> b;
+  b.reserve(size);
+  auto const data = b.buf_.data();
+  cista::serialize(b, g);
+  CHECK(b.buf_.size() == size);
+  CHECK(b.buf_.data() == data);
+
+  auto const deserialized = cista::deserialize<graph>(b.buf_);
+  graph_fixture::check_graph(&deserialized->graph_, 100U);
+  CHECK(*deserialized->single_byte_ == 7U);
+}
+
+TEST_CASE("serialize into reserved mmap") {
+  constexpr auto const FILENAME = "serialized_size_of_mmap.bin";
+
+  auto g = make_graph(100U);
+  auto const size = cista::serialized_size_of(g);
+  {
+    cista::buf<cista::mmap> mmap{cista::mmap{FILENAME}};
+    mmap.reserve(size);
+    auto const data = mmap.buf_.data();
+    cista::serialize(mmap, g);
+    CHECK(mmap.buf_.size() == size);
+    CHECK(mmap.buf_.data() == data);
+  }
+
+  auto b = cista::file(FILENAME, "r").content();
+  CHECK(b.size() == size);
+  auto const deserialized = cista::deserialize<graph>(b);
+  graph_fixture::check_graph(&deserialized->graph_, 100U);
+  CHECK(*deserialized->single_byte_ == 7U);
+}
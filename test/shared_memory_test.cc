@@ -0,0 +1,83 @@
+#ifndef _MSC_VER
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#include "cista/shared_memory.h"
+#endif
+
+namespace shared_memory_test {
+
+namespace data = cista::offset;
+
+struct entry {
+  uint32_t id_{0};
+  data::string name_;
+};
+
+}  // namespace shared_memory_test
+
+using namespace shared_memory_test;
+
+TEST_CASE("shared memory hand-off") {
+  constexpr auto const MODE =
+      cista::mode::WITH_VERSION | cista::mode::WITH_INTEGRITY;
+
+  int sockets[2];
+  REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+
+  data::vector<entry> v;
+  for (auto i = 0U; i != 10000U; ++i) {
+    auto& e = v.emplace_back();
+    e.id_ = i;
+    e.name_.set_owning("ENTRY NAME LONGER THAN 15 CHARS " + std::to_string(i));
+  }
+
+  auto b = cista::buf<cista::mmap>{cista::create_shared_memory()};
+  cista::serialize<MODE>(b, v);
+  auto const size = b.buf_.size();
+  auto const sealed = cista::seal_shared_memory(std::move(b.buf_));
+  REQUIRE(sealed.size() == size);
+  cista::send_fd(sockets[0], sealed.fd());
+
+  auto m = cista::open_shared_memory(cista::receive_fd(sockets[1]));
+  REQUIRE(m.size() == size);
+  CHECK(m.data() != sealed.data());
+  CHECK(std::equal(m.begin(), m.end(), sealed.begin()));
+
+  auto const d = cista::deserialize<data::vector<entry>, MODE>(m);
+  REQUIRE(d->size() == 10000U);
+  CHECK((*d)[9999].id_ == 9999U);
+  CHECK((*d)[9999].name_ == v[9999].name_);
+
+#ifdef CISTA_SEALED_SHARED_MEMORY
+  // Neither the receiver nor the writer can modify or truncate the data.
+  CHECK(::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m.fd(),
+               0) == MAP_FAILED);
+  CHECK(::ftruncate(sealed.fd(), 0) == -1);
+  CHECK(::ftruncate(m.fd(), static_cast<off_t>(size * 2U)) == -1);
+#endif
+
+  ::close(sockets[0]);
+  ::close(sockets[1]);
+}
+
+#ifdef CISTA_SEALED_SHARED_MEMORY
+TEST_CASE("shared memory rejects unsealed file descriptors") {
+  auto const fd = cista::create_shared_memory_fd();
+  REQUIRE(::ftruncate(fd, 4096) == 0);
+  CHECK_THROWS(cista::open_shared_memory(fd));
+}
+#endif
+
+#endif
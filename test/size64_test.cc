@@ -0,0 +1,107 @@
+#include <cinttypes>
+#include <string>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#endif
+
+namespace size64_test {
+
+static_assert(sizeof(cista::offset::string) == 16U);
+static_assert(sizeof(cista::offset::string64) == 24U);
+static_assert(sizeof(cista::raw::vector<int>) == 24U);
+static_assert(sizeof(cista::raw::vector64<int>) == 32U);
+static_assert(cista::offset::string::SHORT_LENGTH_LIMIT == 15U);
+static_assert(cista::offset::string64::SHORT_LENGTH_LIMIT == 23U);
+static_assert(cista::next_power_of_two(uint64_t{5000000000ULL}) ==
+              uint64_t{1ULL} << 33U);
+static_assert(cista::next_power_of_two(uint32_t{1000U}) == 1024U);
+
+// 32bit hashes are unchanged, 64bit sizes are a different type.
+static_assert(cista::type_hash<cista::offset::vector<uint32_t>>() ==
+              12238339724324410118ULL);
+static_assert(cista::type_hash<cista::offset::string>() ==
+              9947774050251227495ULL);
+static_assert(cista::type_hash<cista::offset::vector64<uint32_t>>() !=
+              cista::type_hash<cista::offset::vector<uint32_t>>());
+static_assert(cista::type_hash<cista::offset::string64>() !=
+              cista::type_hash<cista::offset::string>());
+
+// Namespaces can not be template arguments.
+struct offset_ns {
+  template <typename T>
+  using vector64 = cista::offset::vector64<T>;
+  using string64 = cista::offset::string64;
+};
+
+struct raw_ns {
+  template <typename T>
+  using vector64 = cista::raw::vector64<T>;
+  using string64 = cista::raw::string64;
+};
+
+template <typename NS>
+struct graph {
+  typename NS::template vector64<uint64_t> edges_;
+  typename NS::template vector64<typename NS::string64> names_;
+  typename NS::string64 title_;
+};
+
+template <typename NS, cista::mode Mode>
+void roundtrip() {
+  using graph_t = graph<NS>;
+  using string_t = typename NS::string64;
+
+  graph_t g;
+  for (auto i = 0U; i != 1000U; ++i) {
+    g.edges_.push_back(uint64_t{i} << 33U);
+  }
+  g.names_.emplace_back(string_t{"23 characters inline...", string_t::owning});
+  g.names_.emplace_back(
+      string_t{"24 characters, allocated", string_t::owning});
+  g.title_ = string_t{"a rather long graph title", string_t::owning};
+  CHECK(g.names_[0].is_short());
+  CHECK(!g.names_[1].is_short());
+
+  auto buf = cista::serialize<Mode>(g);
+  auto const d = cista::deserialize<graph_t, Mode>(buf);
+  REQUIRE(d->edges_.size() == 1000U);
+  CHECK(d->edges_[999] == uint64_t{999U} << 33U);
+  CHECK(d->names_[0].view() == "23 characters inline...");
+  CHECK(d->names_[1].view() == "24 characters, allocated");
+  CHECK(d->title_.view() == "a rather long graph title");
+}
+
+}  // namespace size64_test
+
+using namespace size64_test;
+
+TEST_CASE("64bit sizes roundtrip") {
+  constexpr auto const MODE =
+      cista::mode::WITH_VERSION | cista::mode::WITH_INTEGRITY;
+  roundtrip<offset_ns, MODE>();
+  roundtrip<raw_ns, MODE>();
+  roundtrip<offset_ns, MODE | cista::mode::SERIALIZE_BIG_ENDIAN>();
+}
+
+TEST_CASE("64bit sizes out of bounds") {
+  namespace data = cista::offset;
+  using vec_t = data::vector64<uint8_t>;
+
+  vec_t v;
+  v.push_back(1U);
+  auto buf = cista::serialize(v);
+  auto const serialized = reinterpret_cast<vec_t*>(&buf[0]);
+  serialized->used_size_ = serialized->allocated_size_ = uint64_t{1U} << 33U;
+  CHECK_THROWS(cista::deserialize<vec_t>(buf));
+
+  using str_t = data::string64;
+  str_t s{"more than twenty-three characters", str_t::owning};
+  buf = cista::serialize(s);
+  reinterpret_cast<str_t*>(&buf[0])->h_.size_ = uint64_t{1U} << 40U;
+  CHECK_THROWS(cista::deserialize<str_t>(buf));
+}
@@ -0,0 +1,164 @@
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#include "cista/snapshot.h"
+#endif
+
+namespace snapshot_test {
+
+namespace data = cista::offset;
+
+constexpr auto const MODE =
+    cista::mode::WITH_VERSION | cista::mode::WITH_INTEGRITY;
+
+using snapshot_t = data::vector<uint32_t>;
+
+inline void write_snapshot(char const* path, uint32_t const value) {
+  snapshot_t v;
+  for (auto i = 0U; i != 1000U; ++i) {
+    v.emplace_back(value);
+  }
+  cista::file f{path, "w+"};
+  cista::serialize<MODE>(f, v);
+}
+
+}  // namespace snapshot_test
+
+using namespace snapshot_test;
+
+TEST_CASE("snapshot manager reclaims after quiescent readers") {
+  constexpr auto const FILE_A = "snapshot_test_a.bin";
+  constexpr auto const FILE_B = "snapshot_test_b.bin";
+  constexpr auto const FILE_BAD = "snapshot_test_bad.bin";
+  write_snapshot(FILE_A, 1U);
+  write_snapshot(FILE_B, 2U);
+  {
+    cista::file f{FILE_BAD, "w+"};
+    auto const garbage = std::string(100U, 'x');
+    f.write(garbage.data(), garbage.size(), 0U);
+  }
+
+  cista::snapshot_manager<snapshot_t, MODE> m;
+  auto r1 = m.register_reader();
+  auto r2 = m.register_reader();
+  CHECK(r1.get() == nullptr);
+
+  m.load(FILE_A);
+  CHECK(m.version() == 1U);
+  auto const a = r1.get();
+  REQUIRE(a != nullptr);
+  CHECK((*a)[999] == 1U);
+
+  m.load_async(FILE_B).get();
+  CHECK(m.version() == 2U);
+
+  // r1 may still reference the old snapshot.
+  CHECK(m.collect() == 1U);
+  CHECK((*a)[0] == 1U);
+  r1.quiescent();
+  CHECK(m.collect() == 1U);  // r2 has not passed a quiescent state yet
+  r2.offline();
+  CHECK(m.collect() == 0U);
+
+  CHECK((*r1.get())[999] == 2U);
+  r2.quiescent();
+
+  CHECK_THROWS(m.load(FILE_BAD));
+  CHECK(m.version() == 2U);
+  CHECK((*r2.get())[0] == 2U);
+}
+
+TEST_CASE("snapshot manager concurrent readers") {
+  char const* const FILES[] = {"snapshot_test_0.bin", "snapshot_test_1.bin",
+                               "snapshot_test_2.bin"};
+  auto value = 0U;
+  for (auto const f : FILES) {
+    write_snapshot(f, value++);
+  }
+
+  cista::snapshot_manager<snapshot_t, MODE> m;
+  m.load(FILES[0]);
+
+  std::atomic_bool stop{false};
+  std::atomic_size_t errors{0U};
+  std::vector<std::thread> readers;
+  for (auto t = 0U; t != 2U; ++t) {
+    readers.emplace_back([&]() {
+      auto r = m.register_reader();
+      while (!stop) {
+        auto const s = r.get();
+        auto const first = (*s)[0];
+        for (auto const x : *s) {
+          if (x != first) {
+            ++errors;
+          }
+        }
+        r.quiescent();
+      }
+    });
+  }
+
+  for (auto i = 0U; i != 30U; ++i) {
+    m.load(FILES[i % 3U]);
+  }
+  stop = true;
+  for (auto& t : readers) {
+    t.join();
+  }
+  m.synchronize();
+  CHECK(errors == 0U);
+  CHECK(m.version() == 31U);
+}
+
+TEST_CASE("snapshot manager readers going offline and online") {
+  char const* const FILES[] = {"snapshot_test_online_0.bin",
+                               "snapshot_test_online_1.bin"};
+  auto value = 0U;
+  for (auto const f : FILES) {
+    write_snapshot(f, value++);
+  }
+
+  cista::snapshot_manager<snapshot_t, MODE> m;
+  m.load(FILES[0]);
+
+  std::atomic_bool stop{false};
+  std::atomic_size_t errors{0U};
+  std::vector<std::thread> readers;
+  for (auto t = 0U; t != 2U; ++t) {
+    readers.emplace_back([&]() {
+      auto r = m.register_reader();
+      while (!stop) {
+        r.offline();
+        std::this_thread::yield();
+        r.quiescent();
+        auto const s = r.get();
+        auto const first = (*s)[0];
+        for (auto const x : *s) {
+          if (x != first) {
+            ++errors;
+          }
+        }
+      }
+      r.offline();
+    });
+  }
+
+  for (auto i = 0U; i != 50U; ++i) {
+    m.load(FILES[i % 2U]);
+  }
+  stop = true;
+  for (auto& t : readers) {
+    t.join();
+  }
+  m.synchronize();
+  CHECK(errors == 0U);
+  CHECK(m.version() == 51U);
+}
@@ -0,0 +1,80 @@
+#include <string>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#endif
+
+namespace {
+
+template <typename Vec>
+void fill(Vec& v) {
+  using string_t = typename Vec::value_type;
+  for (auto i = 0U; i != 300U; ++i) {
+    auto const s = "a rather long repeated string #" + std::to_string(i % 3U);
+    v.emplace_back(string_t{s.c_str(), string_t::owning});
+    v.emplace_back(string_t{"short", string_t::owning});
+  }
+  v.emplace_back(string_t{});
+}
+
+template <typename Vec>
+void check(Vec const& v) {
+  REQUIRE(v.size() == 601U);
+  for (auto i = 0U; i != 300U; ++i) {
+    auto const expected =
+        "a rather long repeated string #" + std::to_string(i % 3U);
+    CHECK(v[2U * i].view() == expected);
+    CHECK(v[2U * i + 1U] == "short");
+  }
+  CHECK(v.back().size() == 0U);
+}
+
+}  // namespace
+
+TEST_CASE("string deduplication raw") {
+  namespace data = cista::raw;
+  constexpr auto const MODE = cista::mode::DEDUPLICATE_STRINGS;
+
+  data::vector<data::string> v;
+  fill(v);
+
+  cista::buf<cista::byte_buf> plain, dedup;
+  auto const plain_stats = cista::serialize(plain, v);
+  auto const stats = cista::serialize<MODE>(dedup, v);
+
+  CHECK(plain_stats.deduplicated_strings_ == 0U);
+  CHECK(stats.deduplicated_strings_ == 297U);
+  CHECK(stats.deduplicated_bytes_ == 297U * 32U);
+  CHECK(dedup.buf_.size() + stats.deduplicated_bytes_ == plain.buf_.size());
+  CHECK(cista::serialized_size_of<MODE>(v) == dedup.buf_.size());
+
+  auto const d =
+      cista::deserialize<data::vector<data::string>, MODE>(dedup.buf_);
+  check(*d);
+  CHECK((*d)[0].data() == (*d)[6].data());
+  CHECK((*d)[0].data() != (*d)[2].data());
+}
+
+TEST_CASE("string deduplication offset with integrity") {
+  namespace data = cista::offset;
+  constexpr auto const MODE = cista::mode::DEDUPLICATE_STRINGS |
+                              cista::mode::WITH_VERSION |
+                              cista::mode::WITH_INTEGRITY;
+
+  data::vector<data::string> v;
+  fill(v);
+
+  auto buf = cista::serialize<MODE>(v);
+  auto const d = cista::deserialize<data::vector<data::string>, MODE>(buf);
+  check(*d);
+  CHECK((*d)[0].data() == (*d)[6].data());
+
+  auto const unchecked =
+      cista::deserialize<data::vector<data::string>,
+                         cista::mode::UNCHECKED | MODE>(buf);
+  check(*unchecked);
+}
@@ -0,0 +1,152 @@
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#endif
+
+namespace trivially_serializable_test {
+
+struct pod {
+  int32_t a_;
+  double b_;
+  cista::array<uint16_t, 3> c_;
+};
+
+struct with_ptr {
+  int32_t a_;
+  pod const* b_;
+};
+
+struct with_string {
+  int32_t a_;
+  cista::raw::string b_;
+};
+
+struct custom {
+  uint32_t v_;
+};
+
+unsigned custom_serialize_calls{0U};
+unsigned custom_deserialize_calls{0U};
+
+template <typename Ctx>
+void serialize(Ctx&, custom const*, cista::offset_t const) {
+  ++custom_serialize_calls;
+}
+
+template <typename Ctx>
+void deserialize(Ctx const&, custom*) {
+  ++custom_deserialize_calls;
+}
+
+struct with_custom {
+  int32_t a_;
+  custom b_;
+};
+
+}  // namespace trivially_serializable_test
+
+using namespace trivially_serializable_test;
+
+using ctx_t = cista::serialization_context<cista::buf<>, cista::mode::NONE>;
+using big_endian_ctx_t =
+    cista::serialization_context<cista::buf<>,
+                                 cista::mode::SERIALIZE_BIG_ENDIAN>;
+
+#if defined(CISTA_LITTLE_ENDIAN)
+static_assert(cista::is_trivially_serializable<ctx_t, int>());
+static_assert(cista::is_trivially_serializable<ctx_t, pod>());
+static_assert(
+    cista::is_trivially_serializable<ctx_t, cista::array<pod, 2>>());
+static_assert(!cista::is_trivially_serializable<big_endian_ctx_t, pod>());
+#endif
+static_assert(!cista::is_trivially_serializable<ctx_t, int*>());
+static_assert(!cista::is_trivially_serializable<ctx_t, with_ptr>());
+static_assert(!cista::is_trivially_serializable<ctx_t, with_string>());
+static_assert(!cista::is_trivially_serializable<ctx_t, custom>());
+static_assert(!cista::is_trivially_serializable<ctx_t, with_custom>());
+static_assert(
+    !cista::is_trivially_serializable<ctx_t, cista::raw::vector<int>>());
+
+using deserialization_ctx_t = cista::deserialization_context<cista::mode::NONE>;
+using big_endian_deserialization_ctx_t =
+    cista::deserialization_context<cista::mode::SERIALIZE_BIG_ENDIAN>;
+
+#if defined(CISTA_LITTLE_ENDIAN)
+static_assert(cista::is_trivially_deserializable<deserialization_ctx_t, pod>());
+static_assert(!cista::is_trivially_deserializable<
+              big_endian_deserialization_ctx_t, pod>());
+#endif
+static_assert(
+    !cista::is_trivially_deserializable<deserialization_ctx_t, with_ptr>());
+static_assert(
+    !cista::is_trivially_deserializable<deserialization_ctx_t, with_custom>());
+static_assert(!cista::is_trivially_deserializable<deserialization_ctx_t,
+                                                  cista::offset::ptr<int>>());
+
+TEST_CASE("trivially serializable vector round trip") {
+  namespace data = cista::offset;
+
+  struct serialize_me {
+    data::vector<pod> pods_;
+    data::unique_ptr<pod> pod_;
+    data::vector<uint32_t> ints_;
+  };
+
+  cista::byte_buf buf;
+  {
+    serialize_me obj;
+    for (auto i = 0; i < 100; ++i) {
+      obj.pods_.emplace_back(
+          pod{i, i * 0.5,
+              {{static_cast<uint16_t>(i), static_cast<uint16_t>(i + 1),
+                static_cast<uint16_t>(i + 2)}}});
+      obj.ints_.emplace_back(static_cast<uint32_t>(i * i));
+    }
+    obj.pod_ = data::make_unique<pod>(pod{7, 7.5, {{7, 8, 9}}});
+    buf = cista::serialize(obj);
+  }
+
+  auto const s = cista::deserialize<serialize_me>(buf);
+  REQUIRE(s->pods_.size() == 100);
+  REQUIRE(s->ints_.size() == 100);
+  for (auto i = 0; i < 100; ++i) {
+    CHECK(s->pods_[i].a_ == i);
+    CHECK(s->pods_[i].b_ == i * 0.5);
+    CHECK(s->pods_[i].c_[2] == i + 2);
+    CHECK(s->ints_[i] == static_cast<uint32_t>(i * i));
+  }
+  CHECK(s->pod_->a_ == 7);
+  CHECK(s->pod_->c_[1] == 8);
+}
+
+TEST_CASE("custom (de)serialize is called for vector elements") {
+  namespace data = cista::raw;
+
+  custom_serialize_calls = 0U;
+  custom_deserialize_calls = 0U;
+
+  data::vector<with_custom> v;
+  v.emplace_back(with_custom{1, custom{2}});
+  v.emplace_back(with_custom{3, custom{4}});
+  auto buf = cista::serialize(v);
+  cista::deserialize<data::vector<with_custom>>(buf);
+
+  CHECK(custom_serialize_calls == 2U);
+  CHECK(custom_deserialize_calls == 2U);
+}
+
+TEST_CASE("trivially deserializable vector range check") {
+  namespace data = cista::raw;
+
+  data::vector<double> v;
+  for (auto i = 0; i < 1000; ++i) {
+    v.emplace_back(i * 0.25);
+  }
+
+  auto buf = cista::serialize(v);
+  buf.resize(buf.size() - 1);
+  CHECK_THROWS(cista::deserialize<data::vector<double>>(buf));
+}
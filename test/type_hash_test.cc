@@ -1,3 +1,5 @@
+#include <map>
+
 #include "doctest.h"
 
 #ifdef SINGLE_HEADER
@@ -21,6 +23,42 @@ struct s2 {
   } j;
   int k;
 };
+
+template <int N>
+struct chain {
+  chain<N - 1> next;
+  int i;
+};
+
+template <>
+struct chain<0> {
+  int i;
+};
+
+struct custom {
+  explicit custom(int i) : i_{i} {}
+  int i_;
+};
+
+struct legacy {
+  int i_;
+};
+
+inline cista::hash_t type_hash(legacy const&, cista::hash_t h,
+                               std::map<cista::hash_t, unsigned>&) {
+  return h;
+}
+
+template <typename Done>
+constexpr cista::hash_t type_hash(custom const*, cista::hash_t h, Done& done) {
+  h = cista::hash_combine(h, cista::hash("custom"));
+  return cista::type_hash(static_cast<int const*>(nullptr), h, done);
+}
+
+struct with_custom {
+  custom c_;
+  int j_;
+};
 }  // namespace hash_test
 
 namespace data = cista::offset;
@@ -58,4 +96,27 @@ TEST_CASE("hash test struct field order") {
 
 TEST_CASE("recursive type hash does work") {
   CHECK(6208585983120472160ULL == cista::type_hash<rec_hash_test::A>());
-}
\ No newline at end of file
+}
+
+TEST_CASE("type hash is a compile time constant") {
+  static_assert(cista::type_hash<hash_test::s1>() == 6887577786639913368ULL);
+  static_assert(cista::type_hash<rec_hash_test::A>() ==
+                6208585983120472160ULL);
+}
+
+TEST_CASE("type hash with many distinct types") {
+  CHECK(8123238778191286517ULL == cista::type_hash<hash_test::chain<70>>());
+}
+
+TEST_CASE("custom type hash") {
+  static_assert(cista::type_hash<hash_test::with_custom>() !=
+                cista::type_hash<hash_test::s1>());
+  CHECK(cista::type_hash<hash_test::with_custom>() !=
+        cista::type_hash<hash_test::chain<1>>());
+}
+
+TEST_CASE("legacy type hash signature is detected") {
+  static_assert(cista::has_legacy_type_hash<hash_test::legacy>::value);
+  static_assert(!cista::has_legacy_type_hash<hash_test::s1>::value);
+  static_assert(!cista::has_legacy_type_hash<int*>::value);
+}
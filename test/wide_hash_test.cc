@@ -0,0 +1,117 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "doctest.h"
+
+#ifdef SINGLE_HEADER
+#include "cista.h"
+#else
+#include "cista/serialization.h"
+#include "cista/wide_hash.h"
+#endif
+
+namespace wide_hash_test {
+
+inline std::vector<char> random_bytes(std::size_t const n) {
+  auto rng = std::mt19937{static_cast<unsigned>(n)};
+  auto dist = std::uniform_int_distribution<int>{0, 255};
+  auto v = std::vector<char>(n);
+  for (auto& c : v) {
+    c = static_cast<char>(dist(rng));
+  }
+  return v;
+}
+
+}  // namespace wide_hash_test
+
+using namespace wide_hash_test;
+
+TEST_CASE("wide hash vectorized equals scalar") {
+  for (auto const n : {0U, 1U, 7U, 8U, 63U, 64U, 65U, 127U, 128U, 1023U, 1024U,
+                       1025U, 4096U, 100000U}) {
+    auto const data = random_bytes(n);
+    auto const s = std::string_view{data.data(), data.size()};
+    CHECK(cista::wide_hash<true>(s) == cista::wide_hash<false>(s));
+  }
+}
+
+TEST_CASE("wide hash reference values") {
+  // Serialized checksums must not depend on the platform / SIMD support.
+  auto s = std::string{};
+  for (auto i = 0; i != 3000; ++i) {
+    s += static_cast<char>('a' + i % 26);
+  }
+  CHECK(cista::wide_hash(std::string_view{}) == 5109744185544637527ULL);
+  CHECK(cista::wide_hash(s) == 11244369721367340760ULL);
+}
+
+TEST_CASE("wide hash streaming equals one-shot") {
+  auto const data = random_bytes(10000U);
+  auto const s = std::string_view{data.data(), data.size()};
+  auto const expected = cista::wide_hash(s);
+  for (auto const chunk_size : {1U, 3U, 63U, 64U, 100U, 1024U, 4095U}) {
+    auto h = cista::wide_hasher{};
+    for (auto i = std::size_t{0U}; i < s.size(); i += chunk_size) {
+      h.update(s.substr(i, chunk_size));
+      h.update(std::string_view{});
+    }
+    CHECK(h.finish() == expected);
+  }
+}
+
+TEST_CASE("wide hash detects changes") {
+  auto data = random_bytes(5000U);
+  auto const s = std::string_view{data.data(), data.size()};
+  auto const h = cista::wide_hash(s);
+
+  CHECK(cista::wide_hash(s.substr(0U, 4999U)) != h);
+  CHECK(cista::wide_hash(std::string_view{"\0", 1U}) !=
+        cista::wide_hash(std::string_view{"\0\0", 2U}));
+  CHECK(cista::wide_hash(std::string_view{}) !=
+        cista::wide_hash(std::string_view{"\0", 1U}));
+
+  for (auto const pos : {0U, 1U, 64U, 1023U, 1024U, 4999U}) {
+    data[pos] ^= 1;
+    CHECK(cista::wide_hash(s) != h);
+    data[pos] ^= 1;
+  }
+  CHECK(cista::wide_hash(s) == h);
+}
+
+TEST_CASE("wide checksum mode") {
+  namespace data = cista::offset;
+  constexpr auto const MODE =
+      cista::mode::WITH_INTEGRITY | cista::mode::WIDE_CHECKSUM;
+  constexpr auto const FILENAME = "wide_checksum_test.bin";
+
+  data::vector<data::string> v;
+  for (auto i = 0U; i != 1000U; ++i) {
+    v.emplace_back().set_owning("STRING LONGER THAN 15 CHARS " +
+                                std::to_string(i));
+  }
+
+  auto buf = cista::serialize<MODE>(v);
+  {
+    cista::buffered_file f{FILENAME};
+    cista::serialize<MODE>(f, v);
+  }
+  {
+    cista::file f{FILENAME, "w+"};
+    cista::serialize<MODE>(f, v);
+  }
+  auto const from_file = cista::file(FILENAME, "r").content();
+  REQUIRE(from_file.size() == buf.size());
+  CHECK(std::memcmp(from_file.data(), buf.data(), buf.size()) == 0);
+
+  auto const deserialized = cista::deserialize<data::vector<data::string>,
+                                               MODE>(buf);
+  REQUIRE(deserialized->size() == 1000U);
+  CHECK((*deserialized)[999] == "STRING LONGER THAN 15 CHARS 999");
+
+  buf[buf.size() - 1U] ^= 1U;
+  CHECK_THROWS((cista::deserialize<data::vector<data::string>, MODE>(buf)));
+  CHECK_THROWS(
+      (cista::deserialize<data::vector<data::string>,
+                          cista::mode::WITH_INTEGRITY>(buf)));
+}
@@ -45,6 +45,8 @@ int main(int argc, char const** argv) {
   std::set<std::string> included;
   std::cout << "#pragma once\n\n";
   for (int i = 2; i < argc; ++i) {
-    write_file(include_path, argv[i], included);
+    if (included.insert(argv[i]).second) {
+      write_file(include_path, argv[i], included);
+    }
   }
 }
\ No newline at end of file